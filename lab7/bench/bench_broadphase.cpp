@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+#include "spatial_grid.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Плотность как в игре: 50 NPC на поле 100x100, мир растёт вместе с числом NPC.
+struct Scene {
+    std::vector<double> xs, ys, kd;
+    double side = 0.0;
+};
+
+Scene makeScene(std::size_t n) {
+    Scene s;
+    s.side = std::sqrt(static_cast<double>(n) * 100.0 * 100.0 / 50.0);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> pos(0.0, s.side);
+    std::uniform_int_distribution<int> kind(0, 1);
+    for (std::size_t i = 0; i < n; ++i) {
+        s.xs.push_back(pos(rng));
+        s.ys.push_back(pos(rng));
+        s.kd.push_back(kind(rng) ? 10.0 : 5.0);
+    }
+    return s;
+}
+
+void BM_PairsBruteForce(benchmark::State &state) {
+    Scene s = makeScene(static_cast<std::size_t>(state.range(0)));
+    const std::size_t n = s.xs.size();
+    for (auto _ : state) {
+        std::size_t hits = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = i + 1; j < n; ++j) {
+                double dx = s.xs[i] - s.xs[j];
+                double dy = s.ys[i] - s.ys[j];
+                double r = std::max(s.kd[i], s.kd[j]);
+                if (dx*dx + dy*dy <= r*r) ++hits;
+            }
+        }
+        benchmark::DoNotOptimize(hits);
+    }
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_PairsBruteForce)->RangeMultiplier(4)->Range(256, 4096)->Complexity();
+
+void BM_PairsSpatialGrid(benchmark::State &state) {
+    Scene s = makeScene(static_cast<std::size_t>(state.range(0)));
+    SpatialGrid grid;
+    for (auto _ : state) {
+        std::size_t hits = 0;
+        grid.rebuild(s.xs.data(), s.ys.data(), s.xs.size(), 10.0);
+        grid.forEachCandidatePair([&](std::uint32_t i, std::uint32_t j) {
+            double dx = s.xs[i] - s.xs[j];
+            double dy = s.ys[i] - s.ys[j];
+            double r = std::max(s.kd[i], s.kd[j]);
+            if (dx*dx + dy*dy <= r*r) ++hits;
+        });
+        benchmark::DoNotOptimize(hits);
+    }
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_PairsSpatialGrid)->RangeMultiplier(4)->Range(256, 262144)->Complexity();
+
+// Большой разреженный мир 100k x 100k: занятых ячеек не больше числа NPC.
+void BM_PairsSparseWorld(benchmark::State &state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> pos(0.0, 100000.0);
+    std::vector<double> xs(n), ys(n);
+    for (std::size_t i = 0; i < n; ++i) { xs[i] = pos(rng); ys[i] = pos(rng); }
+    SpatialGrid grid;
+    for (auto _ : state) {
+        std::size_t candidates = 0;
+        grid.rebuild(xs.data(), ys.data(), n, 10.0);
+        grid.forEachCandidatePair([&](std::uint32_t, std::uint32_t) { ++candidates; });
+        benchmark::DoNotOptimize(candidates);
+    }
+    state.counters["cells"] = static_cast<double>(grid.cellCount());
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_PairsSparseWorld)->RangeMultiplier(8)->Range(4096, 1 << 20)->Complexity();
+
+}
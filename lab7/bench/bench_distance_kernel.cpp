@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+#include "distance_kernel.hpp"
+#include "spatial_grid.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Одна точка против блоков по kRangeBlock кандидатов для каждого уровня ядра.
+void BM_RangeMaskKernel(benchmark::State &state) {
+    const auto level = static_cast<SimdLevel>(state.range(0));
+    RangeMaskFn fn = rangeMaskKernel(level);
+    if (!fn) {
+        state.SkipWithError("not supported by this CPU");
+        return;
+    }
+
+    const std::size_t n = 4096;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> pos(0.0, 40.0);
+    std::vector<double> xs(n), ys(n), rs(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        xs[i] = pos(rng);
+        ys[i] = pos(rng);
+        rs[i] = (i & 1) ? 10.0 : 5.0;
+    }
+
+    for (auto _ : state) {
+        std::uint64_t acc = 0;
+        for (std::size_t q = 0; q < n; q += kRangeBlock) {
+            acc += fn(20.0, 20.0, 5.0, xs.data() + q, ys.data() + q, rs.data() + q, kRangeBlock);
+        }
+        benchmark::DoNotOptimize(acc);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * n));
+    state.SetLabel(simdLevelName(level));
+}
+BENCHMARK(BM_RangeMaskKernel)
+    ->Arg(static_cast<int>(SimdLevel::Scalar))
+    ->Arg(static_cast<int>(SimdLevel::SSE2))
+    ->Arg(static_cast<int>(SimdLevel::AVX2));
+
+// Проход близости целиком: скалярный обход кандидатов против блочного векторного.
+struct Crowd {
+    std::vector<double> xs, ys, rs;
+};
+
+// density — NPC на площадь 100x100
+Crowd makeCrowd(std::size_t n, double density) {
+    Crowd c;
+    double side = std::sqrt(static_cast<double>(n) * 100.0 * 100.0 / density);
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<double> pos(0.0, side);
+    for (std::size_t i = 0; i < n; ++i) {
+        c.xs.push_back(pos(rng));
+        c.ys.push_back(pos(rng));
+        c.rs.push_back((i & 1) ? 10.0 : 5.0);
+    }
+    return c;
+}
+
+void BM_ProximityScalar(benchmark::State &state) {
+    Crowd c = makeCrowd(static_cast<std::size_t>(state.range(0)), static_cast<double>(state.range(1)));
+    SpatialGrid grid;
+    grid.rebuild(c.xs.data(), c.ys.data(), c.xs.size(), 10.0, nullptr, c.rs.data());
+    for (auto _ : state) {
+        std::size_t hits = 0;
+        grid.forEachCandidatePair([&](std::uint32_t i, std::uint32_t j) {
+            double dx = c.xs[i] - c.xs[j];
+            double dy = c.ys[i] - c.ys[j];
+            double r = std::max(c.rs[i], c.rs[j]);
+            if (dx*dx + dy*dy <= r*r) ++hits;
+        });
+        benchmark::DoNotOptimize(hits);
+    }
+}
+BENCHMARK(BM_ProximityScalar)->Args({16384, 50})->Args({262144, 50})->Args({16384, 2000})->Args({65536, 2000});
+
+void BM_ProximityBlocked(benchmark::State &state) {
+    Crowd c = makeCrowd(static_cast<std::size_t>(state.range(0)), static_cast<double>(state.range(1)));
+    SpatialGrid grid;
+    grid.rebuild(c.xs.data(), c.ys.data(), c.xs.size(), 10.0, nullptr, c.rs.data());
+    for (auto _ : state) {
+        std::size_t hits = 0;
+        grid.forEachPairInRange([&](std::uint32_t, std::uint32_t) { ++hits; });
+        benchmark::DoNotOptimize(hits);
+    }
+    state.SetLabel(simdLevelName(detectSimdLevel()));
+}
+BENCHMARK(BM_ProximityBlocked)->Args({16384, 50})->Args({262144, 50})->Args({16384, 2000})->Args({65536, 2000});
+
+}
@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+#include "mpsc_ring.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Fight {
+    std::uint32_t a;
+    std::uint32_t b;
+    std::uint64_t epoch;
+};
+
+constexpr std::size_t kFightsPerProducer = 100000;
+
+// Прежняя схема: deque + mutex + condition_variable, по одному бою за операцию.
+void BM_FightQueueDequeMutex(benchmark::State &state) {
+    const int producers = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        std::deque<Fight> q;
+        std::mutex m;
+        std::condition_variable cv;
+        std::size_t total = kFightsPerProducer * producers;
+
+        std::thread consumer([&]() {
+            for (std::size_t got = 0; got < total; ++got) {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [&]() { return !q.empty(); });
+                Fight f = q.front();
+                q.pop_front();
+                benchmark::DoNotOptimize(f);
+            }
+        });
+        std::vector<std::thread> ps;
+        for (int p = 0; p < producers; ++p) {
+            ps.emplace_back([&]() {
+                for (std::size_t i = 0; i < kFightsPerProducer; ++i) {
+                    {
+                        std::lock_guard<std::mutex> lock(m);
+                        q.push_back({static_cast<std::uint32_t>(i), 0, 0});
+                    }
+                    cv.notify_one();
+                }
+            });
+        }
+        for (auto &t : ps) t.join();
+        consumer.join();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kFightsPerProducer * producers));
+}
+BENCHMARK(BM_FightQueueDequeMutex)->Arg(1)->Arg(2)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// MpscRing: производители кладут пачками по 64, потребитель забирает пачками.
+void BM_FightQueueMpscRing(benchmark::State &state) {
+    const int producers = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        MpscRing<Fight> q(1 << 16);
+        std::atomic<bool> stop{false};
+        std::size_t total = kFightsPerProducer * producers;
+
+        std::thread consumer([&]() {
+            Fight out[64];
+            for (std::size_t got = 0; got < total;) {
+                std::size_t k = q.popBatch(out, 64, stop);
+                benchmark::DoNotOptimize(out);
+                got += k;
+            }
+        });
+        std::vector<std::thread> ps;
+        for (int p = 0; p < producers; ++p) {
+            ps.emplace_back([&]() {
+                Fight buf[64];
+                for (std::size_t i = 0; i < kFightsPerProducer; i += 64) {
+                    std::size_t n = std::min<std::size_t>(64, kFightsPerProducer - i);
+                    for (std::size_t k = 0; k < n; ++k) buf[k] = {static_cast<std::uint32_t>(i + k), 0, 0};
+                    q.pushBatch(buf, n, stop);
+                }
+            });
+        }
+        for (auto &t : ps) t.join();
+        consumer.join();
+        state.counters["high_water"] = static_cast<double>(q.stats().highWater);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kFightsPerProducer * producers));
+}
+BENCHMARK(BM_FightQueueMpscRing)->Arg(1)->Arg(2)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+}
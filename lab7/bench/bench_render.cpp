@@ -0,0 +1,31 @@
+#include <benchmark/benchmark.h>
+#include "dungeon.hpp"
+#include "factory.hpp"
+#include "npc.hpp"
+
+#include <random>
+#include <string>
+
+namespace {
+
+// тепловая карта 200 x 60 по миллиону NPC на n исполнителях
+void BM_RenderHeatmap(benchmark::State &state) {
+    const std::size_t n = 1 << 20;
+    const char* types[] = {"Orc", "Bear", "Squirrel", "Bandit", "Werewolf"};
+    Dungeon d;
+    d.setWorldSize(10000.0, 10000.0);
+    d.setWorkerCount(static_cast<std::size_t>(state.range(0)));
+    std::mt19937 rng(9);
+    std::normal_distribution<double> pos(5000.0, 1500.0);
+    for (std::size_t i = 0; i < n; ++i) {
+        d.addNPC(NPCFactory::create(types[i % 5], "npc_" + std::to_string(i), pos(rng), pos(rng)));
+    }
+    d.setRenderGrid(200, 60);
+    d.setRenderMode(RenderMode::Density);
+
+    for (auto _ : state) benchmark::DoNotOptimize(d.renderAll());
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * n));
+}
+BENCHMARK(BM_RenderHeatmap)->RangeMultiplier(2)->Range(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+}
@@ -0,0 +1,109 @@
+#include <benchmark/benchmark.h>
+#include "dungeon.hpp"
+#include "factory.hpp"
+#include "npc.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace {
+
+// тики без пауз: перемещение, поиск пар и бои подряд
+void fillDungeon(Dungeon &d, std::size_t n) {
+    const char* types[] = {"Orc", "Bear", "Squirrel", "Bandit", "Werewolf"};
+    d.setWorldSize(10000.0, 10000.0);
+    d.setSeed(7);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> pos(0.0, 10000.0);
+    for (std::size_t i = 0; i < n; ++i) {
+        d.addNPC(NPCFactory::create(types[i % 5], "npc_" + std::to_string(i), pos(rng), pos(rng)));
+    }
+}
+
+void BM_RunTicks(benchmark::State &state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    Dungeon d;
+    fillDungeon(d, n);
+
+    TickStats total;
+    for (auto _ : state) {
+        const TickStats s = d.runTicks(1);
+        total.ticks += s.ticks;
+        total.fights += s.fights;
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(total.ticks));
+    state.counters["fights_per_tick"] = static_cast<double>(total.fights) / static_cast<double>(total.ticks);
+}
+BENCHMARK(BM_RunTicks)->Range(1 << 12, 1 << 18)->Unit(benchmark::kMillisecond);
+
+// тики по миру, где большинство уже погибло; аргумент — порог уплотнения (0 — без него)
+void BM_RunTicksMostlyDead(benchmark::State &state) {
+    const std::size_t n = 1 << 18;
+    Dungeon d;
+    d.setCompaction(static_cast<std::size_t>(state.range(0)));
+    fillDungeon(d, n);
+    while (d.aliveCount() * 4 > n) d.runCombat(60.0);
+    d.runTicks(1);
+
+    for (auto _ : state) d.runTicks(1);
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    state.counters["stored"] = static_cast<double>(n - d.compactedCount());
+    state.counters["alive"] = static_cast<double>(d.aliveCount());
+}
+BENCHMARK(BM_RunTicksMostlyDead)->Arg(0)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+// тики, пока другой поток непрерывно сохраняет мир: сохранение читает кадр
+// и не держит блокировку мира
+void BM_RunTicksWithSaver(benchmark::State &state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    Dungeon d;
+    fillDungeon(d, n);
+    d.runTicks(1);
+
+    std::atomic<bool> stop{false};
+    std::atomic<std::uint64_t> saves{0};
+    std::thread saver([&]() {
+        while (!stop.load()) {
+            d.saveToFile("bench_saver.txt");
+            ++saves;
+        }
+    });
+    for (auto _ : state) d.runTicks(1);
+    stop.store(true);
+    saver.join();
+    std::remove("bench_saver.txt");
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    state.counters["saves"] = static_cast<double>(saves.load());
+}
+BENCHMARK(BM_RunTicksWithSaver)->Range(1 << 14, 1 << 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// один раунд runCombat по свежезагруженному миру на n исполнителях
+void BM_RunCombat(benchmark::State &state) {
+    const std::size_t n = 1 << 18;
+    {
+        Dungeon src;
+        fillDungeon(src, n);
+        src.saveToFile("bench_combat.bin", WorldFormat::Binary);
+    }
+    Dungeon d;
+    d.setWorldSize(10000.0, 10000.0);
+    d.setSeed(7);
+    d.setWorkerCount(static_cast<std::size_t>(state.range(0)));
+    CombatSummary last;
+    for (auto _ : state) {
+        state.PauseTiming();
+        d.loadFromFile("bench_combat.bin");
+        state.ResumeTiming();
+        last = d.runCombat(20.0);
+    }
+    std::remove("bench_combat.bin");
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * last.pairs));
+    state.counters["pairs"] = static_cast<double>(last.pairs);
+    state.counters["deaths"] = static_cast<double>(last.deaths);
+}
+BENCHMARK(BM_RunCombat)->RangeMultiplier(2)->Range(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+}
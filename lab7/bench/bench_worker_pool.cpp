@@ -0,0 +1,37 @@
+#include <benchmark/benchmark.h>
+#include "worker_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Фаза перемещения в том же виде, что и в Dungeon: случайный шаг и ограничение миром.
+void BM_MovementPhase(benchmark::State &state) {
+    const std::size_t n = 1 << 20;
+    const std::size_t threads = static_cast<std::size_t>(state.range(0));
+    WorkerPool pool(threads);
+
+    std::vector<double> xs(n, 500.0), ys(n, 500.0), moves(n, 10.0);
+    std::vector<std::mt19937> rngs;
+    for (std::size_t w = 0; w < pool.size(); ++w) rngs.emplace_back(static_cast<unsigned>(w));
+
+    for (auto _ : state) {
+        pool.parallelFor(n, 2048, [&](std::size_t begin, std::size_t end, std::size_t w) {
+            std::uniform_real_distribution<double> ang(0.0, 2.0 * M_PI);
+            for (std::size_t i = begin; i < end; ++i) {
+                double theta = ang(rngs[w]);
+                double nx = xs[i] + moves[i] * std::cos(theta);
+                double ny = ys[i] + moves[i] * std::sin(theta);
+                xs[i] = std::clamp(nx, 0.0, 1000.0);
+                ys[i] = std::clamp(ny, 0.0, 1000.0);
+            }
+        });
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * n));
+}
+BENCHMARK(BM_MovementPhase)->RangeMultiplier(2)->Range(1, 32)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+}
@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+#include "dungeon.hpp"
+#include "factory.hpp"
+#include "npc.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace {
+
+constexpr double kWorld = 10000.0;
+
+void fillDungeon(Dungeon &d, std::size_t n) {
+    const char* types[] = {"Orc", "Bear", "Squirrel", "Bandit", "Werewolf"};
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> pos(0.0, kWorld);
+    d.setWorldSize(kWorld, kWorld);
+    for (std::size_t i = 0; i < n; ++i) {
+        d.addNPC(NPCFactory::create(types[i % 5], "npc_" + std::to_string(i), pos(rng), pos(rng)));
+    }
+}
+
+const char* fileFor(WorldFormat format) {
+    switch (format) {
+        case WorldFormat::Text: return "bench_world.txt";
+        case WorldFormat::Binary: return "bench_world.bin";
+        case WorldFormat::Compressed: return "bench_world.cmp";
+    }
+    return "bench_world";
+}
+
+void BM_SaveWorld(benchmark::State &state, WorldFormat format) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    Dungeon d;
+    fillDungeon(d, n);
+    for (auto _ : state) {
+        if (!d.saveToFile(fileFor(format), format)) state.SkipWithError("save failed");
+    }
+    std::ifstream f(fileFor(format), std::ios::binary | std::ios::ate);
+    state.counters["bytes_per_npc"] = static_cast<double>(f.tellg()) / static_cast<double>(n);
+    std::remove(fileFor(format));
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * n));
+}
+
+void BM_LoadWorld(benchmark::State &state, WorldFormat format) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    {
+        Dungeon src;
+        fillDungeon(src, n);
+        src.saveToFile(fileFor(format), format);
+    }
+    Dungeon d;
+    d.setWorldSize(kWorld, kWorld);
+    for (auto _ : state) {
+        if (!d.loadFromFile(fileFor(format))) state.SkipWithError("load failed");
+    }
+    std::remove(fileFor(format));
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * n));
+}
+
+// разбор текстового файла по кускам на n исполнителях
+void BM_LoadTextWorkers(benchmark::State &state) {
+    const std::size_t n = 1 << 18;
+    {
+        Dungeon src;
+        fillDungeon(src, n);
+        src.saveToFile(fileFor(WorldFormat::Text));
+    }
+    Dungeon d;
+    d.setWorldSize(kWorld, kWorld);
+    d.setWorkerCount(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        if (!d.loadFromFile(fileFor(WorldFormat::Text))) state.SkipWithError("load failed");
+    }
+    std::remove(fileFor(WorldFormat::Text));
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * n));
+}
+
+BENCHMARK_CAPTURE(BM_SaveWorld, text, WorldFormat::Text)->Range(1 << 12, 1 << 18)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SaveWorld, binary, WorldFormat::Binary)->Range(1 << 12, 1 << 18)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SaveWorld, compressed, WorldFormat::Compressed)->Range(1 << 12, 1 << 18)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LoadWorld, text, WorldFormat::Text)->Range(1 << 12, 1 << 18)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LoadWorld, binary, WorldFormat::Binary)->Range(1 << 12, 1 << 18)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LoadWorld, compressed, WorldFormat::Compressed)->Range(1 << 12, 1 << 18)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadTextWorkers)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "mpsc_ring.hpp"
+#include "observer.hpp"
+#include "queue_stats.hpp"
+
+inline constexpr std::size_t kLogNameCap = 48;
+
+// Запись о смерти фиксированного размера; длинные имена обрезаются по
+// границе символа UTF-8 и учитываются в LoggerStats::truncated.
+struct DeathRecord {
+    char killer[kLogNameCap];
+    char victim[kLogNameCap];
+    double x;
+    double y;
+};
+
+struct LoggerStats {
+    QueueStats queue;
+    std::uint64_t dropped = 0;   // не поместились в очередь
+    std::uint64_t truncated = 0; // записи с обрезанным именем
+    std::uint64_t written = 0;
+    std::uint64_t batches = 0;   // число записей в файл
+};
+
+// Наблюдатель, пишущий смерти в файл из отдельного потока.
+// onDeath только кладёт запись в lock-free очередь (при переполнении запись
+// отбрасывается и учитывается в dropped); поток записи собирает пачку и
+// сбрасывает её в файл не реже раза за flushInterval.
+class AsyncFileLogger : public IObserver {
+public:
+    explicit AsyncFileLogger(const std::string &fname,
+                             std::chrono::milliseconds flushInterval = std::chrono::milliseconds(100),
+                             std::size_t capacity = 1 << 14);
+    ~AsyncFileLogger() override;
+
+    AsyncFileLogger(const AsyncFileLogger &) = delete;
+    AsyncFileLogger& operator=(const AsyncFileLogger &) = delete;
+
+    bool isOpen() const noexcept { return open_; }
+
+    void onDeath(const DeathEvent &ev) override;
+
+    // ждёт, пока всё, что уже в очереди, будет записано в файл
+    void flush();
+
+    LoggerStats stats() const noexcept;
+
+private:
+    void writerLoop();
+    std::size_t drain(std::string &out);
+
+    std::ofstream file_;
+    bool open_ = false;
+    std::chrono::milliseconds interval_;
+    MpscRing<DeathRecord> ring_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable flushed_cv_;
+    std::uint64_t flush_requested_ = 0;
+    std::uint64_t flush_done_ = 0;
+    bool stop_ = false;
+
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> truncated_{0};
+    std::atomic<std::uint64_t> written_{0};
+    std::atomic<std::uint64_t> batches_{0};
+
+    std::thread writer_;
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "world_snapshot.hpp"
+
+// Сжатый снимок мира для долговременного хранения.
+// Координаты квантуются с шагом step (ошибка не больше step / 2), записи
+// сортируются по коду Мортона, и в varint хранится разность кодов соседних
+// записей. На ось приходится 32 бита сетки.
+// Имя вида "<основа><число>" хранится номером основы в словаре и числом
+// в отдельном плотно упакованном столбце; тип, статус и номер основы —
+// один varint.
+namespace snapshot {
+
+inline constexpr char kCompressedMagic[8] = {'L', 'A', 'B', '7', 'W', 'C', 'M', 'P'};
+inline constexpr std::uint32_t kCompressedVersion = 1;
+inline constexpr double kDefaultQuantum = 0.01;
+
+bool isCompressed(const std::string &fname);
+
+// false, если step <= 0 или размах координат больше 2^32 шагов
+bool writeCompressed(const std::string &fname, const WorldStore &world, double step = kDefaultQuantum);
+bool writeCompressed(const std::string &fname, const WorldFrame &frame, double step = kDefaultQuantum);
+
+// Последовательное чтение сжатого снимка. Имя в Entry действительно до следующего next().
+class CompressedSnapshot {
+public:
+    using Entry = MappedSnapshot::Entry;
+
+    bool open(const std::string &fname);
+    std::size_t size() const noexcept { return count_; }
+    double step() const noexcept { return step_; }
+
+    // false — записи кончились или данные повреждены (см. failed())
+    bool next(Entry &out);
+    bool failed() const noexcept { return failed_; }
+
+private:
+    bool readVarint(std::uint64_t &v) noexcept;
+    bool readNumber(std::uint64_t &v) noexcept;
+
+    std::string data_;
+    std::size_t pos_ = 0;       // поток записей
+    std::size_t end_ = 0;
+    std::size_t num_pos_ = 0;   // столбец чисел из имён
+    std::size_t num_bit_ = 0;
+    unsigned num_width_ = 0;
+    std::size_t count_ = 0;
+    std::size_t read_ = 0;
+    double step_ = 0;
+    std::vector<std::string> stems_;
+    std::string name_;
+    std::int64_t origin_x_ = 0;
+    std::int64_t origin_y_ = 0;
+    std::uint64_t key_ = 0;    // код Мортона текущей записи
+    bool failed_ = false;
+};
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Векторная проверка дальности: одна точка против блока кандидатов (n <= kRangeBlock).
+// Бит k результата равен 1, если
+//   (ax - xs[k])^2 + (ay - ys[k])^2 <= max(ar, rs[k])^2.
+
+enum class SimdLevel { Scalar, SSE2, AVX2 };
+
+inline constexpr std::size_t kRangeBlock = 64;
+
+using RangeMaskFn = std::uint64_t (*)(double ax, double ay, double ar,
+                                      const double* xs, const double* ys, const double* rs,
+                                      std::size_t n);
+
+// лучший уровень, поддерживаемый процессором (CPUID)
+SimdLevel detectSimdLevel() noexcept;
+const char* simdLevelName(SimdLevel level) noexcept;
+
+// ядро заданного уровня; nullptr, если уровень не собран или не поддерживается
+RangeMaskFn rangeMaskKernel(SimdLevel level) noexcept;
+
+// ядро, выбранное по detectSimdLevel() при первом вызове
+std::uint64_t rangeMask(double ax, double ay, double ar,
+                        const double* xs, const double* ys, const double* rs,
+                        std::size_t n) noexcept;
@@ -1,11 +1,42 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <string>
 #include <mutex>
+#include "queue_stats.hpp"
+#include "tick_scheduler.hpp"
 
 class NPCBase;
 class EventManager;
+struct WorldFrame;
+
+// Text — строка "Тип имя x y" на NPC; Binary — снимок из world_snapshot.hpp;
+// Compressed — квантованный сжатый снимок из compressed_snapshot.hpp
+enum class WorldFormat { Text, Binary, Compressed };
+
+// Full — каждый кадр целиком; AnsiDiff — первый кадр целиком, дальше только
+// заголовок и изменившиеся клетки через ANSI-перемещение курсора.
+// Density и DominantType — тепловая карта по одному символу на клетку:
+// оттенок по числу NPC или символ самого многочисленного типа.
+enum class RenderMode { Full, AnsiDiff, Density, DominantType };
+
+// итог одного раунда runCombat
+struct CombatSummary {
+    std::uint64_t pairs = 0;    // враждебные пары в радиусе
+    std::uint64_t deaths = 0;
+    std::uint64_t alive = 0;    // живых после раунда
+    std::uint32_t waves = 0;    // волн параллельного разрешения
+};
+
+struct TickStats {
+    std::uint64_t ticks = 0;
+    std::uint64_t fights = 0;
+    std::uint64_t deaths = 0;
+    double seconds = 0.0;
+    double ticksPerSecond = 0.0;
+};
 
 class Dungeon {
 public:
@@ -13,20 +44,89 @@ public:
     ~Dungeon();
 
     bool addNPC(std::unique_ptr<NPCBase> npc);
+    // формат файла определяется по сигнатуре
     bool loadFromFile(const std::string &fname);
-    bool saveToFile(const std::string &fname) const;
+    // quantum — шаг сетки координат для Compressed
+    bool saveToFile(const std::string &fname, WorldFormat format = WorldFormat::Text, double quantum = 0.01) const;
     void clear() noexcept;
 
+    // Журнал: base.snap — полный снимок, base.journal — кадры изменений.
+    // checkpoint дописывает только изменения с прошлого вызова; когда журнал
+    // становится заметно больше снимка, снимок переписывается, а журнал очищается.
+    bool startJournal(const std::string &basePath);
+    bool checkpoint();
+    void stopJournal();
+    // снимок и все целые кадры журнала
+    bool loadJournal(const std::string &basePath);
+
+    // Последний опубликованный неизменяемый кадр мира. Во время симуляции
+    // кадр обновляется раз в тик, и чтение не ждёт блокировку мира;
+    // printAll, saveToFile, findNPC и aliveCount работают по нему.
+    // Правки вне тика (addNPC, загрузка, clear, setWorldSize) видны в кадре
+    // сразу после возврата, и во время симуляции тоже.
+    std::shared_ptr<const WorldFrame> frame() const;
+
+    // копия NPC с координатами и состоянием из кадра; nullptr, если имени нет
+    std::unique_ptr<NPCBase> findNPC(const std::string &name) const;
+
+    bool setWorldSize(double width, double height);
+    double worldWidth() const noexcept;
+    double worldHeight() const noexcept;
+
+    // Детерминированный режим: углы шагов и кости боёв зависят только от
+    // (seed, тик, NPC), а следующий тик начинается после разрешения всех боёв
+    // текущего. Один seed и один мир дают одинаковый журнал смертей.
+    // Нельзя менять во время симуляции; отсчёт тиков начинается заново.
+    bool setSeed(std::uint64_t seed);
+
+    // Мёртвые NPC удаляются из мира в начале тика, когда их не меньше minDead
+    // и не меньше четверти мира (по умолчанию minDead = 1024; 0 — не удалять).
+    // Удалённые NPC больше не находятся через findNPC и не попадают в файлы.
+    // Нельзя менять во время симуляции.
+    bool setCompaction(std::size_t minDead);
+    // сколько мёртвых NPC удалено уплотнением
+    std::uint64_t compactedCount() const;
+
+    // число исполнителей параллельных фаз (0 — по числу ядер); нельзя менять во время симуляции
+    bool setWorkerCount(std::size_t n);
+    std::size_t workerCount();
+
+    // кадр собирается в одном буфере и выводится одной записью
     void printAll() const;
+    // кадр, который напечатал бы printAll (в режиме AnsiDiff тоже сдвигает базу для разницы)
+    std::string renderAll() const;
+    void setRenderMode(RenderMode mode);
+    // размер карты в клетках, по умолчанию 10 x 10
+    bool setRenderGrid(std::size_t width, std::size_t height);
+    std::size_t aliveCount() const;
 
     EventManager& events() noexcept;
 
-    void runCombat(double range);
+    // Один синхронный раунд боя без перемещения: все враждебные пары на
+    // расстоянии не больше range дерутся, бои с общими NPC идут в порядке
+    // сетки, остальные — параллельно. Исход не зависит от числа исполнителей,
+    // а с seed воспроизводим. Во время потоковой симуляции не выполняется.
+    CombatSummary runCombat(double range);
+
+    // Прогон n тиков без потоков и пауз: перемещение, поиск и разрешение боёв
+    // подряд в вызывающем потоке. С seed даёт тот же журнал смертей, что и
+    // startSimulation. Во время потоковой симуляции не выполняется.
+    TickStats runTicks(std::uint64_t n);
+
+    // темп потоковой симуляции (по умолчанию 5 тиков в секунду, Skip);
+    // нельзя менять во время симуляции
+    bool setTickRate(double ticksPerSecond, OverrunPolicy policy = OverrunPolicy::Skip);
+    // часы расписания тиков; nullptr — steady_clock. Нельзя менять во время симуляции
+    bool setTickClock(std::shared_ptr<TickClock> clock);
+    // время работы тиков, дрожание и опоздания текущего или последнего прогона
+    TickSchedulerStats tickStats() const;
 
     void startSimulation(int seconds);
     void stopSimulation();
     void joinSimulation();
 
+    QueueStats fightQueueStats() const noexcept;
+
     std::mutex & coutMutex() const noexcept;
 
 private:
@@ -1,13 +1,34 @@
 #pragma once
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "npc.hpp"
 
-
-class NPCBase;
-
+// Разобранная строка "Тип имя x y"
+struct NPCSpec {
+    NPCType type;
+    std::string name;
+    double x;
+    double y;
+};
 
 class NPCFactory {
 public:
     static std::unique_ptr<NPCBase> create(const std::string &type, const std::string &name, double x, double y);
+    static std::unique_ptr<NPCBase> create(NPCType type, const std::string &name, double x, double y);
+    static std::unique_ptr<NPCBase> create(const NPCSpec &spec);
     static std::unique_ptr<NPCBase> createFromLine(const std::string &line);
+
+    static bool parseType(std::string_view token, NPCType &out) noexcept;
+
+    // Разбор без потоков и локали: память выделяется только под имя.
+    // Числа — std::from_chars (допускается ведущий '+'), inf/nan отвергаются.
+    // Токены после y игнорируются, как при чтении через operator>>.
+    static bool parseLine(std::string_view line, NPCSpec &out);
+
+    // Построчный разбор всего буфера; добавляет спецификации в out.
+    // Возвращает число непустых строк, которые не удалось разобрать.
+    static std::size_t parseBuffer(std::string_view buffer, std::vector<NPCSpec> &out);
 };
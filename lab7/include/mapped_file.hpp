@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Файл, отображённый в память только на чтение. Страницы подгружаются
+// при первом обращении, и разбор идёт вперемешку с чтением с диска.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile& operator=(const MappedFile &) = delete;
+
+    // пустой файл открывается без отображения: data() == nullptr
+    bool open(const std::string &fname);
+    void close() noexcept;
+
+    const unsigned char* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return bytes_; }
+    std::string_view text() const noexcept {
+        return {reinterpret_cast<const char*>(data_), bytes_};
+    }
+
+private:
+    const unsigned char* data_ = nullptr;
+    std::size_t bytes_ = 0;
+    // без mmap файл читается сюда целиком
+    std::unique_ptr<unsigned char[]> buffer_;
+};
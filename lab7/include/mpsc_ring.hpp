@@ -0,0 +1,182 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include "queue_stats.hpp"
+
+// Ограниченная lock-free очередь: много производителей, один потребитель.
+// Производители резервируют сразу несколько ячеек одним CAS, потребитель
+// забирает готовые ячейки пачкой и засыпает на atomic::wait, если очередь пуста.
+template <class T>
+class MpscRing {
+public:
+    // capacity округляется вверх до степени двойки
+    explicit MpscRing(std::size_t capacity);
+
+    MpscRing(const MpscRing &) = delete;
+    MpscRing& operator=(const MpscRing &) = delete;
+
+    std::size_t capacity() const noexcept { return mask_ + 1; }
+
+    // Кладёт до n элементов, сколько поместилось; возвращает их число.
+    std::size_t tryPushBatch(const T* items, std::size_t n);
+    bool tryPush(const T &item) { return tryPushBatch(&item, 1) == 1; }
+
+    // Кладёт все n элементов, ожидая освобождения места; при stop прекращает ждать.
+    // Возвращает число положенных элементов.
+    std::size_t pushBatch(const T* items, std::size_t n, const std::atomic<bool> &stop);
+
+    // Только для потребителя.
+    std::size_t tryPopBatch(T* out, std::size_t max);
+    // Ждёт хотя бы один элемент; 0 — очередь пуста и выставлен stop.
+    std::size_t popBatch(T* out, std::size_t max, const std::atomic<bool> &stop);
+
+    // будит спящего потребителя (например, при остановке)
+    void wakeConsumer() noexcept;
+
+    std::size_t depth() const noexcept;
+    QueueStats stats() const noexcept;
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> seq{0};  // pos + 1, когда ячейка pos заполнена
+        T value{};
+    };
+
+    bool ready(std::uint64_t pos) const noexcept {
+        return slots_[pos & mask_].seq.load(std::memory_order_acquire) == pos + 1;
+    }
+    void notifyConsumer() noexcept;
+
+    std::size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(64) std::atomic<std::uint64_t> tail_{0};   // следующая свободная позиция
+    alignas(64) std::atomic<std::uint64_t> head_{0};   // следующая позиция потребителя
+    alignas(64) std::atomic<std::uint32_t> wake_{0};
+    std::atomic<bool> parked_{false};
+
+    std::atomic<std::size_t> highWater_{0};
+    std::atomic<std::uint64_t> fullWaits_{0};
+    std::atomic<std::uint64_t> parks_{0};
+};
+
+template <class T>
+MpscRing<T>::MpscRing(std::size_t capacity) {
+    std::size_t cap = 2;
+    while (cap < capacity) cap <<= 1;
+    mask_ = cap - 1;
+    slots_ = std::make_unique<Slot[]>(cap);
+}
+
+template <class T>
+std::size_t MpscRing<T>::tryPushBatch(const T* items, std::size_t n) {
+    if (n == 0) return 0;
+    std::uint64_t pos = tail_.load(std::memory_order_relaxed);
+    std::size_t k;
+    for (;;) {
+        const std::uint64_t head = head_.load(std::memory_order_acquire);
+        const std::size_t free = capacity() - static_cast<std::size_t>(pos - head);
+        k = std::min(n, free);
+        if (k == 0) return 0;
+        if (tail_.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) break;
+    }
+
+    for (std::size_t i = 0; i < k; ++i) {
+        Slot &s = slots_[(pos + i) & mask_];
+        s.value = items[i];
+        s.seq.store(pos + i + 1, std::memory_order_release);
+    }
+
+    const std::uint64_t head = head_.load(std::memory_order_relaxed);
+    const std::size_t d = pos + k > head ? static_cast<std::size_t>(pos + k - head) : 0;
+    std::size_t hw = highWater_.load(std::memory_order_relaxed);
+    while (d > hw && !highWater_.compare_exchange_weak(hw, d, std::memory_order_relaxed)) {}
+
+    notifyConsumer();
+    return k;
+}
+
+template <class T>
+std::size_t MpscRing<T>::pushBatch(const T* items, std::size_t n, const std::atomic<bool> &stop) {
+    bool waited = false;
+    std::size_t done = 0;
+    while (done < n) {
+        done += tryPushBatch(items + done, n - done);
+        if (done < n) {
+            if (stop.load(std::memory_order_relaxed)) break;
+            if (!waited) fullWaits_.fetch_add(1, std::memory_order_relaxed);
+            waited = true;
+            std::this_thread::yield();
+        }
+    }
+    return done;
+}
+
+template <class T>
+std::size_t MpscRing<T>::tryPopBatch(T* out, std::size_t max) {
+    const std::uint64_t head = head_.load(std::memory_order_relaxed);
+    std::size_t k = 0;
+    while (k < max && ready(head + k)) {
+        out[k] = std::move(slots_[(head + k) & mask_].value);
+        ++k;
+    }
+    if (k) head_.store(head + k, std::memory_order_release);
+    return k;
+}
+
+template <class T>
+std::size_t MpscRing<T>::popBatch(T* out, std::size_t max, const std::atomic<bool> &stop) {
+    constexpr int kSpins = 64;
+    for (;;) {
+        for (int i = 0; i < kSpins; ++i) {
+            if (std::size_t k = tryPopBatch(out, max)) return k;
+            if (stop.load(std::memory_order_relaxed)) return 0;
+        }
+
+        // засыпаем: флаг parked_ и повторная проверка (пара с fence в notifyConsumer)
+        const std::uint32_t w = wake_.load(std::memory_order_relaxed);
+        parked_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!ready(head_.load(std::memory_order_relaxed)) && !stop.load()) {
+            parks_.fetch_add(1, std::memory_order_relaxed);
+            wake_.wait(w, std::memory_order_acquire);
+        }
+        parked_.store(false, std::memory_order_relaxed);
+    }
+}
+
+template <class T>
+void MpscRing<T>::notifyConsumer() noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (parked_.load(std::memory_order_relaxed)) wakeConsumer();
+}
+
+template <class T>
+void MpscRing<T>::wakeConsumer() noexcept {
+    wake_.fetch_add(1, std::memory_order_release);
+    wake_.notify_one();
+}
+
+template <class T>
+std::size_t MpscRing<T>::depth() const noexcept {
+    const std::uint64_t head = head_.load(std::memory_order_acquire);
+    const std::uint64_t tail = tail_.load(std::memory_order_acquire);
+    return tail > head ? static_cast<std::size_t>(tail - head) : 0;
+}
+
+template <class T>
+QueueStats MpscRing<T>::stats() const noexcept {
+    QueueStats s;
+    s.capacity = capacity();
+    s.depth = depth();
+    s.highWater = highWater_.load(std::memory_order_relaxed);
+    s.pushed = tail_.load(std::memory_order_relaxed);
+    s.popped = head_.load(std::memory_order_relaxed);
+    s.fullWaits = fullWaits_.load(std::memory_order_relaxed);
+    s.parks = parks_.load(std::memory_order_relaxed);
+    return s;
+}
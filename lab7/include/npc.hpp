@@ -1,19 +1,52 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include "combat_visitor.hpp"
 
+enum class NPCType : std::uint8_t { Orc, Bear, Squirrel, Bandit, Werewolf };
+
+inline constexpr std::size_t kNPCTypeCount = 5;
+
+inline constexpr const char* kNPCTypeNames[kNPCTypeCount] = {"Orc", "Bear", "Squirrel", "Bandit", "Werewolf"};
+
+constexpr const char* typeName(NPCType t) noexcept {
+    return kNPCTypeNames[static_cast<std::size_t>(t)];
+}
+
+// kKillMatrix[A][B] — A нападает на B и может его убить
+inline constexpr bool kKillMatrix[kNPCTypeCount][kNPCTypeCount] = {
+    //            Orc    Bear   Squirrel Bandit Werewolf
+    /* Orc */    {true,  true,  false,   true,  false},
+    /* Bear */   {false, false, true,    false, false},
+    /* Squirrel*/{false, false, false,   false, false},
+    /* Bandit */ {false, false, false,   false, true },
+    /* Werewolf*/{false, false, false,   true,  false},
+};
+
+constexpr bool canKillType(NPCType a, NPCType b) noexcept {
+    return kKillMatrix[static_cast<std::size_t>(a)][static_cast<std::size_t>(b)];
+}
+
+// пара вступает в бой, если хотя бы один может убить другого
+constexpr bool isHostilePair(NPCType a, NPCType b) noexcept {
+    return canKillType(a, b) || canKillType(b, a);
+}
+
 class NPCBase {
 protected:
+    NPCType typeId_;
     std::string name_;
     double x_;
     double y_;
     bool alive_{true};
 
 public:
-    NPCBase(const std::string& name, double x, double y)
-        : name_(name), x_(x), y_(y) {}
+    NPCBase(NPCType typeId, const std::string& name, double x, double y)
+        : typeId_(typeId), name_(name), x_(x), y_(y) {}
     virtual ~NPCBase() = default;
 
+    NPCType typeId() const noexcept { return typeId_; }
     const std::string& name() const { return name_; }
     double x() const { return x_; }
     double y() const { return y_; }
@@ -1,5 +1,12 @@
 #pragma once
+#include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <memory>
 
@@ -19,10 +26,91 @@ public:
 };
 
 
+// что делать с новым событием, если очередь асинхронной рассылки полна
+enum class OverflowPolicy {
+    Block,       // ждать места
+    DropOldest,  // вытеснить самое старое событие
+    DropNewest,  // отбросить новое событие
+};
+
+struct DispatchStats {
+    std::uint64_t delivered = 0;
+    std::uint64_t dropped = 0;
+    std::size_t highWater = 0;
+    // от notify до возврата из последнего наблюдателя, микросекунды
+    double meanLatencyUs = 0;
+    double p99LatencyUs = 0;   // верхняя граница корзины (степень двойки)
+    double maxLatencyUs = 0;
+};
+
+
+// По умолчанию notify вызывает наблюдателей синхронно, без блокировок:
+// список наблюдателей неизменяем, subscribe публикует новый список.
+// После startAsync notify кладёт событие в кольцевой буфер, а отдельный
+// поток рассылает события наблюдателям в порядке поступления.
 class EventManager {
 public:
+    EventManager() = default;
+    ~EventManager();
+
+    EventManager(const EventManager &) = delete;
+    EventManager& operator=(const EventManager &) = delete;
+
     void subscribe(std::shared_ptr<IObserver> observers_);
     void notify(const DeathEvent &ev) const;
+
+    // false, если асинхронный режим уже включён или capacity == 0
+    bool startAsync(std::size_t capacity = 4096, OverflowPolicy policy = OverflowPolicy::Block);
+    // дорассылает очередь и возвращает синхронный режим
+    void stopAsync();
+    bool isAsync() const;
+
+    // ждёт, пока все поставленные события будут доставлены
+    void waitIdle();
+
+    DispatchStats dispatchStats() const;
+
 private:
-    std::vector<std::shared_ptr<IObserver>> observers_;
+    using Clock = std::chrono::steady_clock;
+
+    struct Queued {
+        DeathEvent ev;
+        Clock::time_point enqueued;
+    };
+
+    static constexpr std::size_t kLatencyBuckets = 40;
+
+    using ObserverList = std::vector<std::shared_ptr<IObserver>>;
+
+    void dispatchLoop();
+    void deliver(const DeathEvent &ev) const;
+
+    // Опубликованный список читается одной загрузкой. Прежние версии живут
+    // до разрушения менеджера: читатель мог загрузить любую из них.
+    std::atomic<const ObserverList*> observers_{nullptr};
+    std::vector<std::unique_ptr<const ObserverList>> observer_lists_;   // под subscribe_mutex_
+    std::mutex subscribe_mutex_;
+
+    // Очередь асинхронной рассылки — внутреннее состояние, поэтому
+    // notify остаётся const. Всё ниже — под mutex_; async_ ещё и читается
+    // без неё в notify, чтобы синхронный режим шёл без блокировки.
+    mutable std::mutex mutex_;
+    mutable std::condition_variable not_empty_;
+    mutable std::condition_variable not_full_;
+    std::condition_variable idle_;
+    mutable std::vector<Queued> ring_;
+    mutable std::size_t head_ = 0;
+    mutable std::size_t count_ = 0;
+    std::size_t in_flight_ = 0;
+    OverflowPolicy policy_ = OverflowPolicy::Block;
+    std::atomic<bool> async_{false};
+    bool stop_ = false;
+    std::thread dispatcher_;
+
+    std::uint64_t delivered_ = 0;
+    mutable std::uint64_t dropped_ = 0;
+    mutable std::size_t high_water_ = 0;
+    double latency_sum_us_ = 0;
+    double latency_max_us_ = 0;
+    std::uint64_t latency_hist_[kLatencyBuckets] = {};
 };
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Множество неупорядоченных пар индексов на один тик.
+// Открытая адресация по упакованному 64-битному ключу; reset() не чистит
+// таблицу, а меняет поколение, поэтому память переиспользуется между тиками.
+class PairSet {
+public:
+    void reset() noexcept;
+    // true, если пары ещё не было
+    bool insert(std::uint32_t a, std::uint32_t b);
+    bool contains(std::uint32_t a, std::uint32_t b) const noexcept;
+    std::size_t size() const noexcept { return size_; }
+
+private:
+    struct Slot {
+        std::uint64_t key = 0;
+        std::uint32_t gen = 0;  // 0 — ячейка никогда не занималась
+    };
+
+    static std::uint64_t pack(std::uint32_t a, std::uint32_t b) noexcept {
+        if (a > b) { std::uint32_t t = a; a = b; b = t; }
+        return (static_cast<std::uint64_t>(a) << 32) | b;
+    }
+    void grow();
+
+    std::vector<Slot> slots_;
+    std::uint32_t gen_ = 1;
+    std::size_t size_ = 0;
+};
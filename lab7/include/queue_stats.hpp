@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Снимок счётчиков очереди.
+struct QueueStats {
+    std::size_t capacity = 0;
+    std::size_t depth = 0;       // элементов в очереди сейчас
+    std::size_t highWater = 0;   // максимальная глубина за всё время
+    std::uint64_t pushed = 0;
+    std::uint64_t popped = 0;
+    std::uint64_t fullWaits = 0; // сколько раз производитель ждал места
+    std::uint64_t parks = 0;     // сколько раз потребитель засыпал
+};
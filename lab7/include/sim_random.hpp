@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+
+// Счётчиковый генератор случайных чисел для симуляции.
+// Значение — хеш от (seed, поток, тик, NPC), поэтому не зависит ни от
+// порядка обработки, ни от того, какой исполнитель считает NPC.
+namespace simrng {
+
+enum Stream : std::uint64_t {
+    kMove = 1,     // угол шага NPC
+    kBattle = 2,   // кости боя пары NPC
+};
+
+// финализатор splitmix64
+constexpr std::uint64_t mix64(std::uint64_t x) noexcept {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+constexpr std::uint64_t draw(std::uint64_t seed, Stream stream, std::uint64_t tick, std::uint64_t a,
+                             std::uint64_t b = 0) noexcept {
+    std::uint64_t h = mix64(seed ^ stream);
+    h = mix64(h ^ tick);
+    h = mix64(h ^ a);
+    return mix64(h ^ b);
+}
+
+// [0, 1) из старших 53 бит
+constexpr double unit(std::uint64_t h) noexcept {
+    return static_cast<double>(h >> 11) * 0x1p-53;
+}
+
+// k-я кость (0..3) из 16-битной части h: 1..6
+constexpr int die(std::uint64_t h, unsigned k) noexcept {
+    return 1 + static_cast<int>((((h >> (16 * k)) & 0xFFFF) * 6) >> 16);
+}
+
+}
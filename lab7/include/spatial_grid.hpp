@@ -0,0 +1,149 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <bit>
+#include <vector>
+#include "distance_kernel.hpp"
+
+// Разреженная хеш-сетка для поиска близких пар (broadphase).
+// Размер ячейки не меньше максимальной дистанции взаимодействия,
+// поэтому кандидаты лежат только в соседних ячейках.
+// Хранятся только занятые ячейки: память растёт с числом точек, а не с площадью мира.
+class SpatialGrid {
+public:
+    // alive != nullptr — точки с нулевым флагом пропускаются;
+    // radii — радиусы взаимодействия для forEachPairInRange
+    void rebuild(const double* xs, const double* ys, std::size_t n, double cellSize,
+                 const std::uint8_t* alive = nullptr, const double* radii = nullptr);
+
+    // Каждая неупорядоченная пара из соседних ячеек выдаётся ровно один раз как f(i, j), i < j.
+    template <class F>
+    void forEachCandidatePair(F &&f) const;
+
+    // Только пары с dist <= max(r_i, r_j); проверка идёт векторным ядром
+    // по блокам кандидатов, лежащих подряд в порядке ячеек.
+    template <class F>
+    void forEachPairInRange(F &&f) const;
+
+    // число занятых ячеек
+    std::size_t cellCount() const noexcept { return cellKey_.size(); }
+
+private:
+    static constexpr std::uint32_t kNoCell = 0xFFFFFFFFu;
+
+    struct Slot {
+        std::uint64_t key;
+        std::uint32_t cell;
+    };
+
+    static std::uint64_t packKey(std::int32_t cx, std::int32_t cy) noexcept {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cy)) << 32)
+             | static_cast<std::uint32_t>(cx);
+    }
+    static std::int32_t keyX(std::uint64_t key) noexcept {
+        return static_cast<std::int32_t>(static_cast<std::uint32_t>(key));
+    }
+    static std::int32_t keyY(std::uint64_t key) noexcept {
+        return static_cast<std::int32_t>(static_cast<std::uint32_t>(key >> 32));
+    }
+
+    std::uint32_t findCell(std::uint64_t key) const noexcept;
+    std::uint32_t findOrAddCell(std::uint64_t key);
+
+    template <class F>
+    void crossCells(std::uint32_t a, std::uint32_t b, F &f) const;
+    template <class F>
+    void scanBlock(std::uint32_t p, std::uint32_t qBegin, std::uint32_t qEnd, F &f) const;
+    void neighbourCells(std::uint32_t c, std::uint32_t out[4]) const noexcept;
+
+    double cell_ = 1.0;
+    std::vector<Slot> table_;             // открытая адресация: ключ ячейки -> номер занятой ячейки
+    std::vector<std::uint64_t> cellKey_;  // ключи занятых ячеек
+    std::vector<std::uint32_t> cellStart_;
+    std::vector<std::uint32_t> items_;
+    std::vector<std::uint32_t> cellOf_;
+    std::vector<std::uint32_t> fill_;
+    // координаты и радиусы в порядке items_
+    std::vector<double> sortedX_;
+    std::vector<double> sortedY_;
+    std::vector<double> sortedR_;
+};
+
+template <class F>
+void SpatialGrid::crossCells(std::uint32_t a, std::uint32_t b, F &f) const {
+    for (std::uint32_t p = cellStart_[a]; p < cellStart_[a + 1]; ++p) {
+        for (std::uint32_t q = cellStart_[b]; q < cellStart_[b + 1]; ++q) {
+            std::uint32_t i = items_[p];
+            std::uint32_t j = items_[q];
+            if (i < j) f(i, j);
+            else f(j, i);
+        }
+    }
+}
+
+template <class F>
+void SpatialGrid::forEachCandidatePair(F &&f) const {
+    const std::uint32_t cells = static_cast<std::uint32_t>(cellKey_.size());
+    for (std::uint32_t c = 0; c < cells; ++c) {
+        std::uint32_t begin = cellStart_[c];
+        std::uint32_t end = cellStart_[c + 1];
+
+        // пары внутри ячейки (items_ внутри ячейки отсортированы по индексу)
+        for (std::uint32_t p = begin; p < end; ++p)
+            for (std::uint32_t q = p + 1; q < end; ++q)
+                f(items_[p], items_[q]);
+
+        std::uint32_t neighbours[4];
+        neighbourCells(c, neighbours);
+        for (std::uint32_t other : neighbours) {
+            if (other != kNoCell) crossCells(c, other, f);
+        }
+    }
+}
+
+template <class F>
+void SpatialGrid::scanBlock(std::uint32_t p, std::uint32_t qBegin, std::uint32_t qEnd, F &f) const {
+    for (std::uint32_t q0 = qBegin; q0 < qEnd; q0 += kRangeBlock) {
+        std::size_t len = std::min<std::size_t>(kRangeBlock, qEnd - q0);
+        std::uint64_t mask = 0;
+        if (len < 4) {
+            // короткие блоки (разреженные ячейки) дешевле проверить на месте
+            for (std::size_t k = 0; k < len; ++k) {
+                double dx = sortedX_[p] - sortedX_[q0 + k];
+                double dy = sortedY_[p] - sortedY_[q0 + k];
+                double r = std::max(sortedR_[p], sortedR_[q0 + k]);
+                if (dx*dx + dy*dy <= r*r) mask |= std::uint64_t{1} << k;
+            }
+        } else {
+            mask = rangeMask(sortedX_[p], sortedY_[p], sortedR_[p],
+                             sortedX_.data() + q0, sortedY_.data() + q0, sortedR_.data() + q0, len);
+        }
+        while (mask) {
+            std::uint32_t q = q0 + static_cast<std::uint32_t>(std::countr_zero(mask));
+            mask &= mask - 1;
+            std::uint32_t i = items_[p];
+            std::uint32_t j = items_[q];
+            if (i < j) f(i, j);
+            else f(j, i);
+        }
+    }
+}
+
+template <class F>
+void SpatialGrid::forEachPairInRange(F &&f) const {
+    const std::uint32_t cells = static_cast<std::uint32_t>(cellKey_.size());
+    for (std::uint32_t c = 0; c < cells; ++c) {
+        std::uint32_t begin = cellStart_[c];
+        std::uint32_t end = cellStart_[c + 1];
+        std::uint32_t neighbours[4];
+        neighbourCells(c, neighbours);
+
+        for (std::uint32_t p = begin; p < end; ++p) {
+            scanBlock(p, p + 1, end, f);
+            for (std::uint32_t other : neighbours) {
+                if (other != kNoCell) scanBlock(p, cellStart_[other], cellStart_[other + 1], f);
+            }
+        }
+    }
+}
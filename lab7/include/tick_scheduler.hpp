@@ -0,0 +1,115 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+// что делать, если тик не уложился в свой период
+enum class OverrunPolicy {
+    Skip,     // пропустить прошедшие слоты расписания, следующий тик — на сетке
+    CatchUp,  // выполнить пропущенные тики подряд без ожидания (не больше maxCatchUp)
+    Stretch,  // следующий тик сразу после опоздавшего, сетка сдвигается от него
+};
+
+struct TickSchedulerStats {
+    std::uint64_t ticks = 0;
+    std::uint64_t overruns = 0;   // тики, чья работа дольше периода
+    std::uint64_t skipped = 0;    // слоты расписания, в которые тик не выполнялся
+    std::uint64_t caughtUp = 0;   // тики, начатые без ожидания ради догоняния
+    // микросекунды; дрожание — опоздание начала тика относительно расписания
+    double periodUs = 0;
+    double meanWorkUs = 0;
+    double maxWorkUs = 0;
+    double meanJitterUs = 0;
+    double maxJitterUs = 0;
+};
+
+// Часы расписания: текущее время и ожидание срока.
+class TickClock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~TickClock() = default;
+    virtual Clock::time_point now() = 0;
+    // Ждёт deadline на cv под lock; раньше — если stop() стал true и cv разбужена.
+    virtual void waitUntil(std::unique_lock<std::mutex> &lock, std::condition_variable &cv,
+                           Clock::time_point deadline, const std::function<bool()> &stop) = 0;
+};
+
+// steady_clock и настоящее ожидание; часы по умолчанию
+class SteadyTickClock : public TickClock {
+public:
+    Clock::time_point now() override;
+    void waitUntil(std::unique_lock<std::mutex> &lock, std::condition_variable &cv, Clock::time_point deadline,
+                   const std::function<bool()> &stop) override;
+};
+
+// Ручные часы для проверок без реального времени. Время идёт только через
+// advance(); с advanceOnWait ожидание само переводит часы на срок.
+class ManualTickClock : public TickClock {
+public:
+    explicit ManualTickClock(bool advanceOnWait = false) : advance_on_wait_(advanceOnWait) {}
+
+    Clock::time_point now() override;
+    void waitUntil(std::unique_lock<std::mutex> &lock, std::condition_variable &cv, Clock::time_point deadline,
+                   const std::function<bool()> &stop) override;
+    // будит ожидающего, если срок наступил
+    void advance(Clock::duration d);
+
+private:
+    const bool advance_on_wait_;
+    std::mutex mutex_;
+    Clock::time_point now_{};
+    // ожидающий в waitUntil: его мьютекс и условная переменная
+    std::mutex* waiter_mutex_ = nullptr;
+    std::condition_variable* waiter_cv_ = nullptr;
+};
+
+// Расписание тиков с фиксированным периодом; по умолчанию по steady_clock.
+// Цикл: start(); while (waitNext()) { работа; endTick(); }
+class TickScheduler {
+public:
+    using Clock = TickClock::Clock;
+
+    // clock == nullptr — SteadyTickClock
+    explicit TickScheduler(Clock::duration period = std::chrono::milliseconds(200),
+                           OverrunPolicy policy = OverrunPolicy::Skip, std::size_t maxCatchUp = 4,
+                           std::shared_ptr<TickClock> clock = nullptr);
+
+    TickScheduler(const TickScheduler &) = delete;
+    TickScheduler& operator=(const TickScheduler &) = delete;
+
+    // false, если period <= 0; не вызывать во время цикла
+    bool configure(Clock::duration period, OverrunPolicy policy, std::size_t maxCatchUp = 4);
+    Clock::duration period() const;
+    // nullptr — SteadyTickClock; не вызывать во время цикла
+    void setClock(std::shared_ptr<TickClock> clock);
+
+    // сбрасывает статистику и отмену; первый тик начинается сразу
+    void start();
+    // ждёт начала следующего тика; false после cancel()
+    bool waitNext();
+    // конец работы тика: замер и выбор следующего слота по политике
+    void endTick();
+    void cancel();
+
+    TickSchedulerStats stats() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    Clock::duration period_;
+    OverrunPolicy policy_;
+    std::size_t max_catch_up_;
+    std::shared_ptr<TickClock> clock_;
+    bool cancelled_ = false;
+
+    Clock::time_point next_;        // начало следующего тика по расписанию
+    Clock::time_point tick_start_;
+    TickSchedulerStats stats_;
+    double work_sum_us_ = 0;
+    double jitter_sum_us_ = 0;
+};
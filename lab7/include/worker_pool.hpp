@@ -0,0 +1,43 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул рабочих потоков для параллельных фаз тика.
+// Вызывающий поток работает как исполнитель 0, остальные — потоки пула.
+class WorkerPool {
+public:
+    using RangeFn = std::function<void(std::size_t begin, std::size_t end, std::size_t worker)>;
+
+    // threads == 0 — по числу аппаратных потоков
+    explicit WorkerPool(std::size_t threads = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool& operator=(const WorkerPool &) = delete;
+
+    std::size_t size() const noexcept { return threads_.size() + 1; }
+
+    // Делит [0, n) на непрерывные части (не меньше minChunk элементов) и
+    // возвращается, когда все части обработаны (барьер).
+    // Вызовы из разных потоков выполняются по очереди; вложенные вызовы из fn запрещены.
+    void parallelFor(std::size_t n, std::size_t minChunk, const RangeFn &fn);
+
+private:
+    void workerLoop(std::size_t worker);
+
+    std::vector<std::thread> threads_;
+    std::mutex call_mutex_;
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    const RangeFn* job_ = nullptr;
+    std::size_t job_n_ = 0;
+    std::size_t job_parts_ = 0;
+    std::size_t generation_ = 0;
+    std::size_t pending_ = 0;
+    bool stop_ = false;
+};
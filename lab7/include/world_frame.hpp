@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "npc.hpp"
+#include "world_store.hpp"
+
+// Имена NPC для кадров мира. Имя не меняется после добавления, поэтому
+// полные блоки по kBlock имён делятся между кадрами; копируется только хвост.
+class NameTable {
+public:
+    static constexpr std::size_t kBlock = 4096;
+
+    // имена [0, world.size()); блоки prev переиспользуются, если prev построен
+    // для того же мира (без clear/load между ними)
+    static std::shared_ptr<const NameTable> extend(const std::shared_ptr<const NameTable> &prev,
+                                                   const WorldStore &world);
+
+    std::size_t size() const noexcept { return count_; }
+    const std::string& operator[](NPCId id) const noexcept { return (*blocks_[id / kBlock])[id % kBlock]; }
+
+    // kNoNPC, если имени нет; при повторах — первый NPC, как в WorldStore.
+    // Индекс строится при первом поиске.
+    NPCId find(std::string_view name) const;
+
+private:
+    std::vector<std::shared_ptr<const std::vector<std::string>>> blocks_;
+    std::size_t count_ = 0;
+
+    mutable std::once_flag index_once_;
+    mutable std::vector<NPCId> index_;   // открытая адресация: id + 1, 0 — пусто
+};
+
+// Неизменяемый кадр мира: координаты и статусы на конец тика.
+// Симуляция публикует кадр после каждого тика; читатели держат
+// shared_ptr и обходят кадр без блокировок мира.
+struct WorldFrame {
+    std::uint64_t tick = 0;      // тиков выполнено к моменту кадра
+    std::uint64_t epoch = 0;     // world_epoch мира кадра
+    std::uint64_t layout = 0;    // номер уплотнения: NPCId кадров с разным layout не сравнимы
+    std::uint64_t version = 0;   // счётчик изменений мира на момент кадра
+    double width = 0;
+    double height = 0;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<NPCType> types;
+    std::vector<std::uint8_t> aliveFlags;
+    std::size_t aliveCount = 0;
+    std::shared_ptr<const NameTable> names;
+
+    std::size_t size() const noexcept { return xs.size(); }
+    double x(NPCId id) const noexcept { return xs[id]; }
+    double y(NPCId id) const noexcept { return ys[id]; }
+    NPCType type(NPCId id) const noexcept { return types[id]; }
+    bool alive(NPCId id) const noexcept { return aliveFlags[id] != 0; }
+    const std::string& name(NPCId id) const noexcept { return (*names)[id]; }
+
+    NPCId find(std::string_view name) const { return names->find(name); }
+    // копия NPC, как WorldStore::materialize
+    std::unique_ptr<NPCBase> materialize(NPCId id) const;
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "npc.hpp"
+#include "world_store.hpp"
+
+// Журнал изменений мира поверх бинарного снимка.
+// Файл — последовательность кадров [заголовок][записи]; один кадр на checkpoint.
+// Кадр с неверной длиной или контрольной суммой (оборванная запись)
+// и всё после него при воспроизведении игнорируются.
+namespace journal {
+
+inline constexpr std::uint32_t kFrameMagic = 0x4C4E524Au;  // "JRNL"
+
+struct FrameHeader {
+    std::uint32_t magic;
+    std::uint32_t bytes;      // длина записей кадра
+    std::uint32_t checksum;   // FNV-1a по записям
+};
+
+enum RecordTag : std::uint8_t {
+    kSpawn = 'S',   // type u8, alive u8, x f64, y f64, длина имени u16, имя
+    kDeath = 'D',   // id u32
+    kMove = 'M',    // id u32, dx f32, dy f32 — сдвиг от позиции в журнале
+};
+
+// Записи одного кадра.
+class Frame {
+public:
+    void spawn(NPCType type, std::string_view name, double x, double y, bool alive);
+    void death(NPCId id);
+    void move(NPCId id, float dx, float dy);
+
+    bool empty() const noexcept { return bytes_.empty(); }
+    std::size_t size() const noexcept { return bytes_.size(); }
+    void clear() noexcept { bytes_.clear(); }
+
+    // дописывает кадр в конец файла
+    bool appendTo(const std::string &fname) const;
+
+private:
+    std::string bytes_;
+};
+
+// пустой журнал (после нового снимка)
+bool truncate(const std::string &fname);
+
+// Применяет к world все целые кадры. Отсутствующий файл — пустой журнал.
+// Возвращает число применённых кадров.
+std::size_t replay(const std::string &fname, WorldStore &world);
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "mapped_file.hpp"
+#include "npc.hpp"
+#include "world_store.hpp"
+
+struct WorldFrame;
+
+// Бинарный снимок мира.
+// [заголовок][записи фиксированной ширины][таблица имён]
+// Числа хранятся в порядке байт машины; снимок не переносится между
+// архитектурами с разным порядком байт.
+namespace snapshot {
+
+inline constexpr char kMagic[8] = {'L', 'A', 'B', '7', 'W', 'R', 'L', 'D'};
+inline constexpr std::uint32_t kVersion = 1;
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    std::uint64_t count;
+    std::uint64_t namesBytes;
+};
+
+struct Record {
+    double x;
+    double y;
+    std::uint32_t nameOffset;   // смещение в таблице имён
+    std::uint16_t nameLength;
+    std::uint8_t type;          // NPCType
+    std::uint8_t alive;
+};
+
+static_assert(sizeof(Header) == 32);
+static_assert(sizeof(Record) == 24);
+
+// true, если файл начинается с сигнатуры снимка
+bool isSnapshot(const std::string &fname);
+
+bool write(const std::string &fname, const WorldStore &world);
+bool write(const std::string &fname, const WorldFrame &frame);
+
+// все записи по порядку, без фильтрации: NPCId совпадают с номерами записей
+bool read(const std::string &fname, WorldStore &out);
+
+// Файл снимка, отображённый в память только на чтение.
+// Проверка структуры выполняется целиком в open(), после неё
+// записи читаются без разбора и без проверок.
+class MappedSnapshot {
+public:
+    struct Entry {
+        NPCType type;
+        std::string_view name;
+        double x;
+        double y;
+        bool alive;
+    };
+
+    MappedSnapshot() = default;
+    ~MappedSnapshot();
+    MappedSnapshot(const MappedSnapshot &) = delete;
+    MappedSnapshot& operator=(const MappedSnapshot &) = delete;
+
+    bool open(const std::string &fname);
+    void close() noexcept;
+
+    std::size_t size() const noexcept { return count_; }
+    Entry entry(std::size_t i) const noexcept;
+
+private:
+    MappedFile file_;
+    std::size_t count_ = 0;
+    const Record* records_ = nullptr;
+    const char* names_ = nullptr;
+};
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "npc.hpp"
+
+using NPCId = std::uint32_t;
+
+inline constexpr NPCId kNoNPC = 0xFFFFFFFFu;
+
+// Стабильная ссылка на NPC, переживает compact(): младшие 32 бита — слот
+// таблицы описателей, старшие — поколение слота. Слот удалённого NPC
+// переиспользуется с новым поколением, старый описатель становится недействительным.
+using NPCHandle = std::uint64_t;
+
+// Хранилище мира в виде структуры массивов (SoA).
+// NPCId — индекс в колонках, стабилен до clear() или compact().
+// Имена проиндексированы хеш-таблицей: поиск по имени за O(1).
+class WorldStore {
+public:
+    // при повторном имени индекс продолжает указывать на первого NPC
+    NPCId add(const NPCBase &npc);
+    NPCId add(NPCType type, std::string name, double x, double y);
+    std::unique_ptr<NPCBase> materialize(NPCId id) const;
+
+    // kNoNPC, если такого имени нет
+    NPCId find(std::string_view name) const noexcept;
+
+    // kNoNPC, если NPC удалён уплотнением или описатель из другого мира
+    NPCId resolve(NPCHandle h) const noexcept;
+
+    // Удаляет мёртвых NPC, сохраняя порядок живых, и отдаёт их слоты
+    // описателей на повторное использование; возвращает число удалённых.
+    std::size_t compact();
+
+    void reserve(std::size_t n);
+    void clear() noexcept;
+    std::size_t size() const noexcept { return x_.size(); }
+
+    double x(NPCId id) const noexcept { return x_[id]; }
+    double y(NPCId id) const noexcept { return y_[id]; }
+    NPCType type(NPCId id) const noexcept { return type_[id]; }
+    bool alive(NPCId id) const noexcept { return alive_[id] != 0; }
+    double moveDistance(NPCId id) const noexcept { return move_[id]; }
+    double killDistance(NPCId id) const noexcept { return kill_[id]; }
+    const std::string& name(NPCId id) const noexcept { return name_[id]; }
+    NPCHandle handle(NPCId id) const noexcept { return handle_[id]; }
+
+    void setPosition(NPCId id, double nx, double ny) noexcept { x_[id] = nx; y_[id] = ny; }
+    void markDead(NPCId id) noexcept { alive_[id] = 0; }
+
+    // колонки целиком — для линейных проходов
+    double* xs() noexcept { return x_.data(); }
+    double* ys() noexcept { return y_.data(); }
+    const double* xs() const noexcept { return x_.data(); }
+    const double* ys() const noexcept { return y_.data(); }
+    const NPCType* types() const noexcept { return type_.data(); }
+    const std::uint8_t* aliveFlags() const noexcept { return alive_.data(); }
+    const double* moveDistances() const noexcept { return move_.data(); }
+    const double* killDistances() const noexcept { return kill_.data(); }
+    const NPCHandle* handles() const noexcept { return handle_.data(); }
+
+private:
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<NPCType> type_;
+    std::vector<std::uint8_t> alive_;
+    std::vector<double> move_;
+    std::vector<double> kill_;
+    std::vector<std::string> name_;
+    std::vector<NPCHandle> handle_;
+
+    // слот описателя -> NPCId (kNoNPC — свободен) и его текущее поколение
+    std::vector<NPCId> slot_id_;
+    std::vector<std::uint32_t> slot_gen_;
+    std::vector<std::uint32_t> free_slots_;
+
+    // открытая адресация: id + 1, 0 — пусто; загрузка не выше 1/2
+    std::vector<NPCId> index_;
+    void indexInsert(NPCId id);
+    void rehash(std::size_t capacity);
+};
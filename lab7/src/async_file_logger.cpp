@@ -0,0 +1,119 @@
+#include "async_file_logger.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr std::size_t kWriteBatch = 256;
+
+// false, если имя не поместилось; обрезка не разрывает многобайтный символ
+bool copyName(char (&dst)[kLogNameCap], const std::string &src) noexcept {
+    std::size_t n = src.size();
+    const bool fits = n < kLogNameCap;
+    if (!fits) {
+        n = kLogNameCap - 1;
+        // src[n] — первый отброшенный байт; продолжение последовательности
+        // значит, что её начало тоже надо отбросить
+        while (n > 0 && (static_cast<unsigned char>(src[n]) & 0xC0) == 0x80) --n;
+    }
+    std::memcpy(dst, src.data(), n);
+    dst[n] = '\0';
+    return fits;
+}
+
+// тот же текст, что печатал FileLogger: числа в формате operator<< по умолчанию
+void appendRecord(std::string &out, const DeathRecord &r) {
+    char line[2 * kLogNameCap + 96];
+    int len = std::snprintf(line, sizeof(line), "%s убил %s в точке (%g,%g)\n", r.killer, r.victim, r.x, r.y);
+    if (len > 0) out.append(line, std::min(static_cast<std::size_t>(len), sizeof(line) - 1));
+}
+
+}
+
+AsyncFileLogger::AsyncFileLogger(const std::string &fname, std::chrono::milliseconds flushInterval,
+                                 std::size_t capacity)
+    : file_(fname, std::ios::app), open_(static_cast<bool>(file_)), interval_(flushInterval), ring_(capacity) {
+    if (open_) writer_ = std::thread([this]() { writerLoop(); });
+}
+
+AsyncFileLogger::~AsyncFileLogger() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_cv_.notify_one();
+    if (writer_.joinable()) writer_.join();
+}
+
+void AsyncFileLogger::onDeath(const DeathEvent &ev) {
+    if (!open_) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    DeathRecord r;
+    const bool fits = copyName(r.killer, ev.killer) & copyName(r.victim, ev.victim);
+    if (!fits) truncated_.fetch_add(1, std::memory_order_relaxed);
+    r.x = ev.x;
+    r.y = ev.y;
+    if (!ring_.tryPush(r)) dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AsyncFileLogger::flush() {
+    if (!open_) return;
+    std::unique_lock<std::mutex> lock(mutex_);
+    const std::uint64_t ticket = ++flush_requested_;
+    wake_cv_.notify_one();
+    flushed_cv_.wait(lock, [&]() { return flush_done_ >= ticket; });
+}
+
+LoggerStats AsyncFileLogger::stats() const noexcept {
+    LoggerStats s;
+    s.queue = ring_.stats();
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    s.truncated = truncated_.load(std::memory_order_relaxed);
+    s.written = written_.load(std::memory_order_relaxed);
+    s.batches = batches_.load(std::memory_order_relaxed);
+    return s;
+}
+
+std::size_t AsyncFileLogger::drain(std::string &out) {
+    DeathRecord batch[kWriteBatch];
+    std::size_t total = 0;
+    while (std::size_t k = ring_.tryPopBatch(batch, kWriteBatch)) {
+        for (std::size_t i = 0; i < k; ++i) appendRecord(out, batch[i]);
+        total += k;
+    }
+    return total;
+}
+
+void AsyncFileLogger::writerLoop() {
+    std::string out;
+    for (;;) {
+        std::uint64_t requested;
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_cv_.wait_for(lock, interval_, [&]() { return stop_ || flush_requested_ != flush_done_; });
+            requested = flush_requested_;
+            stopping = stop_;
+        }
+
+        // одна запись в файл на интервал, сколько бы смертей ни накопилось
+        out.clear();
+        const std::size_t n = drain(out);
+        if (n) {
+            file_.write(out.data(), static_cast<std::streamsize>(out.size()));
+            file_.flush();
+            written_.fetch_add(n, std::memory_order_relaxed);
+            batches_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            flush_done_ = requested;
+        }
+        flushed_cv_.notify_all();
+        if (stopping) return;
+    }
+}
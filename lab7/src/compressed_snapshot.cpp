@@ -0,0 +1,296 @@
+#include "compressed_snapshot.hpp"
+#include "world_frame.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+
+namespace snapshot {
+
+namespace {
+
+struct CompressedHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t count;
+    double step;
+    std::int64_t originX;   // минимальные координаты в шагах сетки
+    std::int64_t originY;
+};
+
+static_assert(sizeof(CompressedHeader) == 48);
+
+// число в конце имени длиннее этого хранится как часть основы
+constexpr std::size_t kMaxSuffixDigits = 18;
+
+void putVarint(std::string &out, std::uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+// вставляет нулевой бит между битами v
+std::uint64_t spreadBits(std::uint32_t v) noexcept {
+    std::uint64_t x = v;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x << 2)) & 0x3333333333333333ull;
+    x = (x | (x << 1)) & 0x5555555555555555ull;
+    return x;
+}
+
+std::uint32_t compactBits(std::uint64_t x) noexcept {
+    x &= 0x5555555555555555ull;
+    x = (x | (x >> 1)) & 0x3333333333333333ull;
+    x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x >> 4)) & 0x00FF00FF00FF00FFull;
+    x = (x | (x >> 8)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x >> 16)) & 0x00000000FFFFFFFFull;
+    return static_cast<std::uint32_t>(x);
+}
+
+// число бит, достаточное для v
+unsigned bitWidth(std::uint64_t v) noexcept {
+    unsigned w = 0;
+    while (v) {
+        ++w;
+        v >>= 1;
+    }
+    return w;
+}
+
+// основа имени и число без ведущих нулей в конце; иначе всё имя — основа
+bool splitName(std::string_view name, std::string_view &stem, std::uint64_t &number) noexcept {
+    std::size_t i = name.size();
+    while (i > 0 && name[i - 1] >= '0' && name[i - 1] <= '9') --i;
+    const std::string_view digits = name.substr(i);
+    stem = name;
+    if (digits.empty() || digits.size() > kMaxSuffixDigits) return false;
+    if (digits.size() > 1 && digits.front() == '0') return false;
+    std::from_chars(digits.data(), digits.data() + digits.size(), number);
+    stem = name.substr(0, i);
+    return true;
+}
+
+}
+
+bool isCompressed(const std::string &fname) {
+    std::ifstream f(fname, std::ios::binary);
+    char magic[sizeof(kCompressedMagic)];
+    if (!f.read(magic, sizeof(magic))) return false;
+    return std::memcmp(magic, kCompressedMagic, sizeof(kCompressedMagic)) == 0;
+}
+
+namespace {
+
+template <class World>
+bool writeCompressedWorld(const std::string &fname, const World &world, double step) {
+    if (!(step > 0) || !std::isfinite(step)) return false;
+    const std::size_t n = world.size();
+
+    std::vector<std::int64_t> qx(n), qy(n);
+    std::int64_t minx = 0, miny = 0;
+    for (NPCId id = 0; id < n; ++id) {
+        const double fx = std::round(world.x(id) / step);
+        const double fy = std::round(world.y(id) / step);
+        if (!(std::fabs(fx) < 0x1p62) || !(std::fabs(fy) < 0x1p62)) return false;
+        qx[id] = static_cast<std::int64_t>(fx);
+        qy[id] = static_cast<std::int64_t>(fy);
+        if (id == 0 || qx[id] < minx) minx = qx[id];
+        if (id == 0 || qy[id] < miny) miny = qy[id];
+    }
+
+    // код Мортона по сетке, сдвинутой к началу координат; по 32 бита на ось
+    std::vector<std::pair<std::uint64_t, NPCId>> order(n);
+    for (NPCId id = 0; id < n; ++id) {
+        const std::uint64_t cx = static_cast<std::uint64_t>(qx[id] - minx);
+        const std::uint64_t cy = static_cast<std::uint64_t>(qy[id] - miny);
+        if (cx > 0xFFFFFFFFu || cy > 0xFFFFFFFFu) return false;
+        order[id] = {spreadBits(static_cast<std::uint32_t>(cx)) | (spreadBits(static_cast<std::uint32_t>(cy)) << 1), id};
+    }
+    std::sort(order.begin(), order.end());
+
+    std::unordered_map<std::string_view, std::uint64_t> stemIndex;
+    std::vector<std::string_view> stems;
+    std::vector<std::uint64_t> numbers;
+    std::string records;
+    records.reserve(n * 5);
+    std::uint64_t prev = 0;
+    for (const auto &[key, id] : order) {
+        std::string_view stem;
+        std::uint64_t number = 0;
+        const bool hasNumber = splitName(world.name(id), stem, number);
+        auto [it, inserted] = stemIndex.emplace(stem, stems.size());
+        if (inserted) stems.push_back(stem);
+        if (hasNumber) numbers.push_back(number);
+
+        const std::uint64_t kind = it->second * kNPCTypeCount + static_cast<std::uint64_t>(world.type(id));
+        putVarint(records, (kind << 2) | (world.alive(id) ? 2u : 0u) | (hasNumber ? 1u : 0u));
+        putVarint(records, key - prev);
+        prev = key;
+    }
+
+    CompressedHeader h{};
+    std::memcpy(h.magic, kCompressedMagic, sizeof(kCompressedMagic));
+    h.version = kCompressedVersion;
+    h.count = n;
+    h.step = step;
+    h.originX = minx;
+    h.originY = miny;
+
+    std::string dict;
+    putVarint(dict, stems.size());
+    for (std::string_view s : stems) {
+        putVarint(dict, s.size());
+        dict.append(s);
+    }
+    putVarint(dict, records.size());
+
+    // числа из имён случайны в порядке Мортона — плотная упаковка по width бит
+    // вместо varint экономит почти байт на NPC
+    std::uint64_t maxNumber = 0;
+    for (std::uint64_t v : numbers) maxNumber = std::max(maxNumber, v);
+    const unsigned width = bitWidth(maxNumber);
+    std::string packed(1, static_cast<char>(width));
+    std::uint64_t acc = 0;
+    unsigned bits = 0;
+    for (std::uint64_t v : numbers) {
+        for (unsigned done = 0; done < width;) {
+            const unsigned take = std::min(width - done, 64 - bits);
+            const std::uint64_t part = (v >> done) & (take == 64 ? ~0ull : ((1ull << take) - 1));
+            acc |= part << bits;
+            bits += take;
+            done += take;
+            if (bits == 64) {
+                for (unsigned b = 0; b < 64; b += 8) packed.push_back(static_cast<char>(acc >> b));
+                acc = 0;
+                bits = 0;
+            }
+        }
+    }
+    for (unsigned b = 0; b < bits; b += 8) packed.push_back(static_cast<char>(acc >> b));
+
+    std::ofstream f(fname, std::ios::binary | std::ios::trunc);
+    if (!f) return false;
+    f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    f.write(dict.data(), static_cast<std::streamsize>(dict.size()));
+    f.write(records.data(), static_cast<std::streamsize>(records.size()));
+    f.write(packed.data(), static_cast<std::streamsize>(packed.size()));
+    return static_cast<bool>(f);
+}
+
+}
+
+bool writeCompressed(const std::string &fname, const WorldStore &world, double step) {
+    return writeCompressedWorld(fname, world, step);
+}
+
+bool writeCompressed(const std::string &fname, const WorldFrame &frame, double step) {
+    return writeCompressedWorld(fname, frame, step);
+}
+
+bool CompressedSnapshot::readVarint(std::uint64_t &v) noexcept {
+    v = 0;
+    for (unsigned shift = 0; shift < 64 && pos_ < end_; shift += 7) {
+        const auto b = static_cast<unsigned char>(data_[pos_++]);
+        v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+bool CompressedSnapshot::readNumber(std::uint64_t &v) noexcept {
+    if (num_bit_ + num_width_ > data_.size() * 8) return false;
+    v = 0;
+    for (unsigned got = 0; got < num_width_;) {
+        const auto byte = static_cast<unsigned char>(data_[num_bit_ / 8]);
+        const unsigned off = num_bit_ % 8;
+        const unsigned take = std::min(8 - off, num_width_ - got);
+        v |= static_cast<std::uint64_t>((byte >> off) & ((1u << take) - 1)) << got;
+        got += take;
+        num_bit_ += take;
+    }
+    return true;
+}
+
+bool CompressedSnapshot::open(const std::string &fname) {
+    *this = CompressedSnapshot{};
+    std::ifstream f(fname, std::ios::binary | std::ios::ate);
+    if (!f) return false;
+    data_.resize(static_cast<std::size_t>(f.tellg()));
+    f.seekg(0);
+    if (!f.read(data_.data(), static_cast<std::streamsize>(data_.size()))) return false;
+
+    CompressedHeader h;
+    if (data_.size() < sizeof(h)) return false;
+    std::memcpy(&h, data_.data(), sizeof(h));
+    if (std::memcmp(h.magic, kCompressedMagic, sizeof(kCompressedMagic)) != 0 || h.version != kCompressedVersion ||
+        !(h.step > 0) || h.count > data_.size()) {
+        return false;
+    }
+    pos_ = sizeof(h);
+    end_ = data_.size();
+    count_ = static_cast<std::size_t>(h.count);
+    step_ = h.step;
+    origin_x_ = h.originX;
+    origin_y_ = h.originY;
+
+    std::uint64_t stems;
+    if (!readVarint(stems) || stems > data_.size()) return false;
+    stems_.resize(static_cast<std::size_t>(stems));
+    for (auto &s : stems_) {
+        std::uint64_t len;
+        if (!readVarint(len) || len > data_.size() - pos_) return false;
+        s.assign(data_, pos_, static_cast<std::size_t>(len));
+        pos_ += static_cast<std::size_t>(len);
+    }
+
+    std::uint64_t recordBytes;
+    if (!readVarint(recordBytes) || recordBytes >= data_.size() - pos_) return false;
+    num_pos_ = pos_ + static_cast<std::size_t>(recordBytes);
+    end_ = num_pos_;
+    num_width_ = static_cast<unsigned char>(data_[num_pos_]);
+    if (num_width_ > 64) return false;
+    num_bit_ = (num_pos_ + 1) * 8;
+    return true;
+}
+
+bool CompressedSnapshot::next(Entry &out) {
+    if (failed_ || read_ == count_) return false;
+    std::uint64_t tag, number = 0, delta;
+    bool ok = readVarint(tag);
+    const bool hasNumber = tag & 1;
+    if (ok && hasNumber) ok = readNumber(number);
+    ok = ok && readVarint(delta);
+    const std::uint64_t kind = tag >> 2;
+    if (!ok || kind / kNPCTypeCount >= stems_.size()) {
+        failed_ = true;
+        return false;
+    }
+
+    name_ = stems_[static_cast<std::size_t>(kind / kNPCTypeCount)];
+    if (hasNumber) {
+        char digits[24];
+        auto res = std::to_chars(digits, digits + sizeof(digits), number);
+        name_.append(digits, res.ptr);
+    }
+    key_ += delta;
+
+    out.type = static_cast<NPCType>(kind % kNPCTypeCount);
+    out.name = name_;
+    out.x = static_cast<double>(origin_x_ + compactBits(key_)) * step_;
+    out.y = static_cast<double>(origin_y_ + compactBits(key_ >> 1)) * step_;
+    out.alive = (tag & 2) != 0;
+    ++read_;
+    return true;
+}
+
+}
@@ -0,0 +1,122 @@
+#include "distance_kernel.hpp"
+#include <algorithm>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define LAB7_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+std::uint64_t rangeMaskScalar(double ax, double ay, double ar,
+                              const double* xs, const double* ys, const double* rs,
+                              std::size_t n) {
+    std::uint64_t mask = 0;
+    for (std::size_t k = 0; k < n; ++k) {
+        double dx = ax - xs[k];
+        double dy = ay - ys[k];
+        double r = std::max(ar, rs[k]);
+        if (dx*dx + dy*dy <= r*r) mask |= std::uint64_t{1} << k;
+    }
+    return mask;
+}
+
+#ifdef LAB7_X86_SIMD
+
+__attribute__((target("sse2")))
+std::uint64_t rangeMaskSSE2(double ax, double ay, double ar,
+                            const double* xs, const double* ys, const double* rs,
+                            std::size_t n) {
+    const __m128d vax = _mm_set1_pd(ax);
+    const __m128d vay = _mm_set1_pd(ay);
+    const __m128d var = _mm_set1_pd(ar);
+    std::uint64_t mask = 0;
+    std::size_t k = 0;
+    for (; k + 2 <= n; k += 2) {
+        __m128d dx = _mm_sub_pd(vax, _mm_loadu_pd(xs + k));
+        __m128d dy = _mm_sub_pd(vay, _mm_loadu_pd(ys + k));
+        __m128d r = _mm_max_pd(var, _mm_loadu_pd(rs + k));
+        __m128d d2 = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+        __m128d hit = _mm_cmple_pd(d2, _mm_mul_pd(r, r));
+        mask |= static_cast<std::uint64_t>(_mm_movemask_pd(hit)) << k;
+    }
+    if (k < n) mask |= rangeMaskScalar(ax, ay, ar, xs + k, ys + k, rs + k, n - k) << k;
+    return mask;
+}
+
+__attribute__((target("avx2")))
+std::uint64_t rangeMaskAVX2(double ax, double ay, double ar,
+                            const double* xs, const double* ys, const double* rs,
+                            std::size_t n) {
+    const __m256d vax = _mm256_set1_pd(ax);
+    const __m256d vay = _mm256_set1_pd(ay);
+    const __m256d var = _mm256_set1_pd(ar);
+    std::uint64_t mask = 0;
+    std::size_t k = 0;
+    for (; k + 4 <= n; k += 4) {
+        __m256d dx = _mm256_sub_pd(vax, _mm256_loadu_pd(xs + k));
+        __m256d dy = _mm256_sub_pd(vay, _mm256_loadu_pd(ys + k));
+        __m256d r = _mm256_max_pd(var, _mm256_loadu_pd(rs + k));
+        __m256d d2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+        __m256d hit = _mm256_cmp_pd(d2, _mm256_mul_pd(r, r), _CMP_LE_OQ);
+        mask |= static_cast<std::uint64_t>(_mm256_movemask_pd(hit)) << k;
+    }
+    // хвост считаем здесь же: вызов не-VEX кода при грязных верхних половинах ymm дорог
+    for (; k < n; ++k) {
+        double dx = ax - xs[k];
+        double dy = ay - ys[k];
+        double r = std::max(ar, rs[k]);
+        if (dx*dx + dy*dy <= r*r) mask |= std::uint64_t{1} << k;
+    }
+    return mask;
+}
+
+#endif
+
+RangeMaskFn selectKernel() noexcept {
+    return rangeMaskKernel(detectSimdLevel());
+}
+
+}
+
+SimdLevel detectSimdLevel() noexcept {
+#ifdef LAB7_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::SSE2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+const char* simdLevelName(SimdLevel level) noexcept {
+    switch (level) {
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+RangeMaskFn rangeMaskKernel(SimdLevel level) noexcept {
+#ifdef LAB7_X86_SIMD
+    __builtin_cpu_init();
+#endif
+    switch (level) {
+        case SimdLevel::Scalar:
+            return &rangeMaskScalar;
+#ifdef LAB7_X86_SIMD
+        case SimdLevel::SSE2:
+            return __builtin_cpu_supports("sse2") ? &rangeMaskSSE2 : nullptr;
+        case SimdLevel::AVX2:
+            return __builtin_cpu_supports("avx2") ? &rangeMaskAVX2 : nullptr;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+std::uint64_t rangeMask(double ax, double ay, double ar,
+                        const double* xs, const double* ys, const double* rs,
+                        std::size_t n) noexcept {
+    static const RangeMaskFn kernel = selectKernel();
+    return kernel(ax, ay, ar, xs, ys, rs, n);
+}
@@ -3,157 +3,1103 @@
 #include "observer.hpp"
 #include "combat_visitor.hpp"
 #include "npc.hpp"
+#include "spatial_grid.hpp"
+#include "world_store.hpp"
+#include "world_frame.hpp"
+#include "world_snapshot.hpp"
+#include "mapped_file.hpp"
+#include "compressed_snapshot.hpp"
+#include "world_journal.hpp"
+#include "worker_pool.hpp"
+#include "mpsc_ring.hpp"
+#include "pair_set.hpp"
+#include "sim_random.hpp"
+#include "tick_scheduler.hpp"
 
+#include <cassert>
 #include <fstream>
 #include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <thread>
 #include <atomic>
-#include <shared_mutex>
 #include <condition_variable>
-#include <deque>
-#include <random>
+#include <shared_mutex>
 #include <chrono>
-#include <set>
+#include <charconv>
 #include <cmath>
 #include <unordered_map>
 
+static constexpr std::size_t kFightQueueCapacity = 1 << 16;
+static constexpr std::size_t kFightBatch = 1024;
+static constexpr std::size_t kCompactMinDead = 1024;
+// журнал длиннее снимка в столько раз заменяется новым снимком
+static constexpr std::uint64_t kJournalCompactRatio = 4;
+// текстовый файл меньше этого разбирается одним куском
+static constexpr std::size_t kLoadChunkBytes = 1 << 20;
+static constexpr std::size_t kLoadChunksPerWorker = 4;
+
 struct Dungeon::Impl {
-    std::vector<std::shared_ptr<NPCBase>> npcs;
+    WorldStore world;
+    // меняется при clear/load: бои из очереди для старого мира отбрасываются
+    std::uint64_t world_epoch = 0;
+    // Меняется при уплотнении: NPCId другие, описатели прежние. Уплотнение —
+    // в начале тика, когда мёртвых не меньше compact_min_dead и четверти мира.
+    std::uint64_t layout = 0;
+    std::size_t compact_min_dead = kCompactMinDead;
+    std::uint64_t compacted = 0;   // удалено NPC за всё время
+    void compactIfNeeded();
     EventManager events;
 
+    // границы мира: [0, world_w] x [0, world_h]
+    double world_w = 100.0;
+    double world_h = 100.0;
+
+    bool inBounds(double x, double y) const noexcept {
+        return x >= 0 && x <= world_w && y >= 0 && y <= world_h;
+    }
+
+    // NPC боя — описатели: бой в очереди переживает уплотнение мира
+    struct Fight {
+        NPCHandle a;
+        NPCHandle b;
+        std::uint64_t epoch;
+        std::uint64_t tick;
+    };
+
     mutable std::shared_mutex npcs_mutex;
     std::mutex cout_mutex;
-    std::mutex queue_mutex;
-    std::condition_variable queue_cv;
-    std::deque<std::pair<std::shared_ptr<NPCBase>, std::shared_ptr<NPCBase>>> fight_queue;
+    MpscRing<Fight> fight_queue{kFightQueueCapacity};
+    // бои текущего тика; в очередь уходят после снятия блокировки мира
+    std::vector<Fight> tick_fights;
     std::atomic<bool> stop_flag{false};
+    // темп потока перемещений; по умолчанию 5 тиков в секунду
+    TickScheduler scheduler;
     std::thread movement_thread;
     std::thread battle_thread;
+
+    // broadphase тика, переиспользуется потоком перемещений между тиками
+    SpatialGrid grid;
+#ifndef NDEBUG
+    // только проверка в отладочной сборке: сетка не выдаёт пару дважды
+    PairSet seen_in_tick;
+#endif
+
+    // пул для параллельных фаз; 0 потоков — по числу ядер
+    std::mutex pool_mutex;
+    std::size_t worker_count = 0;
+    std::unique_ptr<WorkerPool> pool;
+    // Случайность — simrng от (seed, тик, NPC). С заданным seed движение
+    // ждёт, пока бои тика разрешены, и прогон полностью воспроизводим.
+    std::uint64_t seed = 0;
+    bool seeded = false;
+    std::uint64_t tick = 0;             // номер тика перемещения; сбрасывается со сменой мира
+    std::mutex tick_mutex;
+    std::condition_variable tick_cv;
+    std::uint64_t fights_pushed = 0;    // только поток перемещений
+    std::uint64_t fights_resolved = 0;  // под tick_mutex
+
+    // разбиение пачки боёв на волны без общих NPC; fight_ids — NPCId боёв
+    // пачки, kNoNPC — бой устарел (другой мир или NPC уже удалён)
+    std::vector<std::pair<NPCId, NPCId>> fight_ids;
+    std::vector<std::uint32_t> npc_stamp;
+    std::vector<std::uint32_t> npc_wave;
+    std::uint32_t batch_stamp = 0;
+    std::vector<std::uint32_t> fight_wave;
+    std::vector<std::uint32_t> wave_start;
+    std::vector<std::uint32_t> wave_order;
+    std::vector<std::uint32_t> wave_fill;
+    std::vector<std::uint8_t> fight_outcome;
+
+    // Журнал: снимок + кадры изменений. Поля меняются под эксклюзивной
+    // блокировкой мира; journal_mutex упорядочивает запись кадров в файл.
+    struct Journal {
+        bool active = false;
+        std::string snap_path;
+        std::string log_path;
+        std::uint64_t epoch = 0;        // world_epoch, для которого снят снимок
+        std::uint64_t layout = 0;       // layout снимка; после уплотнения — новый снимок
+        std::size_t synced = 0;         // NPC [0, synced) уже есть в снимке или журнале
+        std::vector<double> jx, jy;     // позиции, которые восстановит воспроизведение
+        std::vector<std::uint8_t> dirty;
+        std::vector<std::vector<NPCId>> moved;  // по исполнителям фазы перемещения
+        std::vector<NPCId> died;
+        std::uint64_t snapshot_bytes = 0;
+        std::uint64_t journal_bytes = 0;
+    } journal;
+    std::mutex journal_mutex;
+
+    // отрисовка карты: буфер кадра и клетки прошлого кадра для режима AnsiDiff
+    std::mutex render_mutex;
+    RenderMode render_mode = RenderMode::Full;
+    std::size_t grid_w = 10;
+    std::size_t grid_h = 10;
+    std::vector<char> cells;
+    std::vector<char> prev_cells;   // пусто — следующий кадр рисуется целиком
+    std::string frame;
+    // гистограммы тепловой карты: [клетка * kNPCTypeCount + тип], своя у каждого исполнителя
+    std::vector<std::vector<std::uint32_t>> partial_hist;
+    std::vector<std::uint32_t> hist;
+    // Свой пул у отрисовки: пул симуляции занят тиком под эксклюзивной
+    // блокировкой мира, и кадр ждал бы его целиком
+    std::unique_ptr<WorkerPool> render_pool;   // под render_mutex
+
+    WorkerPool& renderWorkers() {
+        if (!render_pool) {
+            std::size_t n;
+            {
+                std::lock_guard<std::mutex> lock(pool_mutex);
+                n = worker_count;
+            }
+            render_pool = std::make_unique<WorkerPool>(n);
+        }
+        return *render_pool;
+    }
+
+    void renderFrame(const WorldFrame &wf);
+    void renderHeatmap(const WorldFrame &wf);
+
+    // Кадры для читателей. Любое изменение мира увеличивает world_version под
+    // эксклюзивной блокировкой; кадр с тем же version актуален. Во время
+    // симуляции кадр публикует поток перемещений после каждого тика, и читатели
+    // не трогают npcs_mutex; вне симуляции устаревший кадр собирается заново.
+    // Правки вне тика (addNPC, загрузка, clear) увеличивают ещё и world_edits:
+    // такой кадр собирается заново и во время симуляции.
+    std::atomic<std::uint64_t> world_version{0};
+    std::atomic<std::uint64_t> world_edits{0};
+    std::atomic<bool> sim_running{false};
+    std::mutex frame_mutex;
+    std::shared_ptr<const WorldFrame> published;   // под frame_mutex
+    std::uint64_t published_edits = 0;             // под frame_mutex
+    std::mutex publish_mutex;
+    std::shared_ptr<WorldFrame> live_frame;    // тот же кадр, что в published
+
+    // Кадр, который отпустили все читатели: его возвращает удалитель shared_ptr
+    // под mutex, и повторное использование буферов упорядочено мьютексом.
+    // Кадры держат recycler, поэтому переживают Dungeon.
+    struct FrameRecycler {
+        std::mutex mutex;
+        std::unique_ptr<WorldFrame> spare;
+    };
+    std::shared_ptr<FrameRecycler> recycler = std::make_shared<FrameRecycler>();
+
+    // pool — копирование колонок параллельно; только из потока перемещений
+    std::shared_ptr<const WorldFrame> publish(WorkerPool *pool = nullptr);
+    std::shared_ptr<const WorldFrame> currentFrame();
+
+    bool journalRebase();
+    bool journalCollect(journal::Frame &frame);
+
+    WorkerPool& workers() {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (!pool) pool = std::make_unique<WorkerPool>(worker_count);
+        return *pool;
+    }
+
+    // без seed — от часов
+    void pickSeed();
+    // фазы тика: общие для потоков симуляции и runTicks
+    std::uint64_t moveTick(WorkerPool &pool);
+    void detectFights(std::uint64_t t);
+    // range > 0 — общая дальность боя вместо дистанций убийства (runCombat)
+    void resolveFights(const Fight* fights, std::size_t n, std::vector<DeathEvent> &deaths, double range = 0.0);
+    std::uint32_t last_waves = 0;   // волн в последнем вызове resolveFights
+
+    // runTicks и runCombat делят буферы потока перемещений; вызовы идут по очереди
+    std::mutex step_mutex;
+    std::vector<double> combat_radii;
 };
 
+// исход боя
+enum : std::uint8_t { kNoKill = 0, kAKillsB = 1, kBKillsA = 2, kBothDie = 3 };
+
+// минимальная волна боёв на одного исполнителя
+static constexpr std::size_t kFightChunk = 256;
+
+// Бои одной волны не делят NPC и идут параллельно; волны — по порядку,
+// поэтому бои с общим NPC выполняются в том же порядке, что и в очереди.
+// Вызывается под эксклюзивной блокировкой мира; события — в порядке боёв.
+void Dungeon::Impl::resolveFights(const Fight* fights, std::size_t n, std::vector<DeathEvent> &deaths, double range) {
+    if (npc_stamp.size() < world.size()) {
+        npc_stamp.resize(world.size(), 0);
+        npc_wave.resize(world.size(), 0);
+    }
+    if (++batch_stamp == 0) {
+        std::fill(npc_stamp.begin(), npc_stamp.end(), 0);
+        batch_stamp = 1;
+    }
+
+    ++world_version;
+    fight_ids.resize(n);
+    for (std::size_t k = 0; k < n; ++k) {
+        const Fight &f = fights[k];
+        NPCId a = kNoNPC, b = kNoNPC;
+        if (f.epoch == world_epoch) {
+            a = world.resolve(f.a);
+            b = world.resolve(f.b);
+            if (b == kNoNPC) a = kNoNPC;
+        }
+        fight_ids[k] = {a, b};
+    }
+
+    fight_wave.assign(n, 0);
+    fight_outcome.assign(n, kNoKill);
+    std::uint32_t waves = 0;
+    for (std::size_t k = 0; k < n; ++k) {
+        const auto [a, b] = fight_ids[k];
+        if (a == kNoNPC) continue;
+        std::uint32_t w = 0;
+        for (NPCId id : {a, b}) {
+            if (npc_stamp[id] == batch_stamp) w = std::max(w, npc_wave[id] + 1);
+        }
+        for (NPCId id : {a, b}) {
+            npc_stamp[id] = batch_stamp;
+            npc_wave[id] = w;
+        }
+        fight_wave[k] = w;
+        waves = std::max(waves, w + 1);
+    }
+
+    // раскладка номеров боёв по волнам
+    last_waves = waves;
+    wave_start.assign(waves + 1, 0);
+    for (std::size_t k = 0; k < n; ++k) {
+        if (fight_ids[k].first != kNoNPC) ++wave_start[fight_wave[k] + 1];
+    }
+    for (std::uint32_t w = 0; w < waves; ++w) wave_start[w + 1] += wave_start[w];
+    wave_order.resize(wave_start[waves]);
+    wave_fill.assign(wave_start.begin(), wave_start.end() - 1);
+    for (std::size_t k = 0; k < n; ++k) {
+        if (fight_ids[k].first != kNoNPC) wave_order[wave_fill[fight_wave[k]]++] = static_cast<std::uint32_t>(k);
+    }
+
+    WorkerPool &pool = workers();
+    for (std::uint32_t w = 0; w < waves; ++w) {
+        const std::uint32_t* order = wave_order.data() + wave_start[w];
+        const std::size_t count = wave_start[w + 1] - wave_start[w];
+
+        pool.parallelFor(count, kFightChunk, [&](std::size_t begin, std::size_t end, std::size_t) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const std::uint32_t k = order[i];
+                const auto [A, B] = fight_ids[k];
+
+                if (!world.alive(A) || !world.alive(B)) continue;
+
+                double dx = world.x(A) - world.x(B);
+                double dy = world.y(A) - world.y(B);
+                double dist2 = dx*dx + dy*dy;
+                double maxRange = range > 0.0 ? range : std::max(world.killDistance(A), world.killDistance(B));
+                if (dist2 > maxRange * maxRange) continue;
+
+                bool A_wins = false;
+                bool B_wins = false;
+
+                // кости от описателей: уплотнение мира не меняет исход
+                const std::uint64_t h = simrng::draw(seed, simrng::kBattle, fights[k].tick, fights[k].a, fights[k].b);
+                if (canKillType(world.type(A), world.type(B))) {
+                    if (simrng::die(h, 0) > simrng::die(h, 1)) A_wins = true;
+                }
+                if (canKillType(world.type(B), world.type(A))) {
+                    if (simrng::die(h, 2) > simrng::die(h, 3)) B_wins = true;
+                }
+
+                if (A_wins) world.markDead(B);
+                if (B_wins) world.markDead(A);
+                fight_outcome[k] = static_cast<std::uint8_t>((A_wins ? kAKillsB : 0) | (B_wins ? kBKillsA : 0));
+            }
+        });
+    }
+
+    for (std::size_t k = 0; k < n; ++k) {
+        const auto [A, B] = fight_ids[k];
+        if (fight_outcome[k] & kAKillsB) deaths.push_back({world.name(A), world.name(B), world.x(B), world.y(B)});
+        if (fight_outcome[k] & kBKillsA) deaths.push_back({world.name(B), world.name(A), world.x(A), world.y(A)});
+        if (journal.active) {
+            if (fight_outcome[k] & kAKillsB) journal.died.push_back(B);
+            if (fight_outcome[k] & kBKillsA) journal.died.push_back(A);
+        }
+    }
+}
+
+// Новый снимок и пустой журнал. Под эксклюзивной блокировкой мира.
+bool Dungeon::Impl::journalRebase() {
+    if (!snapshot::write(journal.snap_path, world) || !journal::truncate(journal.log_path)) return false;
+    const std::size_t n = world.size();
+    journal.epoch = world_epoch;
+    journal.layout = layout;
+    journal.synced = n;
+    journal.jx.assign(world.xs(), world.xs() + n);
+    journal.jy.assign(world.ys(), world.ys() + n);
+    journal.dirty.assign(n, 0);
+    for (auto &list : journal.moved) list.clear();
+    journal.died.clear();
+    journal.snapshot_bytes = sizeof(snapshot::Header) + n * sizeof(snapshot::Record);
+    for (NPCId id = 0; id < n; ++id) journal.snapshot_bytes += world.name(id).size();
+    journal.journal_bytes = 0;
+    return true;
+}
+
+// Изменения с прошлого checkpoint: появившиеся, погибшие и сдвинувшиеся NPC.
+// Работа пропорциональна числу изменений. Под эксклюзивной блокировкой мира.
+bool Dungeon::Impl::journalCollect(journal::Frame &frame) {
+    const std::size_t synced = journal.synced;
+    // новые NPC записываются целиком, вместе с позицией и статусом
+    for (NPCId id = static_cast<NPCId>(synced); id < world.size(); ++id) {
+        frame.spawn(world.type(id), world.name(id), world.x(id), world.y(id), world.alive(id));
+        journal.jx.push_back(world.x(id));
+        journal.jy.push_back(world.y(id));
+        journal.dirty.push_back(0);
+    }
+    for (NPCId id : journal.died) {
+        if (id < synced) frame.death(id);
+    }
+    journal.died.clear();
+
+    for (auto &list : journal.moved) {
+        for (NPCId id : list) {
+            journal.dirty[id] = 0;
+            if (id >= synced) continue;
+            // сдвиг во float; копия позиции журнала повторяет округление воспроизведения
+            const float dx = static_cast<float>(world.x(id) - journal.jx[id]);
+            const float dy = static_cast<float>(world.y(id) - journal.jy[id]);
+            if (dx == 0.0f && dy == 0.0f) continue;
+            journal.jx[id] += dx;
+            journal.jy[id] += dy;
+            frame.move(id, dx, dy);
+        }
+        list.clear();
+    }
+    journal.synced = world.size();
+    return true;
+}
+
+// минимальный кусок фазы перемещения на одного исполнителя
+static constexpr std::size_t kMoveChunk = 2048;
+// копирование колонок в кадр
+static constexpr std::size_t kFrameChunk = 16384;
+
 Dungeon::Dungeon() : pimpl_(new Impl()) {}
 Dungeon::~Dungeon() {
     stopSimulation();
     joinSimulation();
+    // наблюдатели могут ссылаться на coutMutex — дорассылаем до разрушения Impl
+    pimpl_->events.stopAsync();
     delete pimpl_;
 }
 
 bool Dungeon::addNPC(std::unique_ptr<NPCBase> npc) {
     if (!npc) return false;
-    if (npc->x() < 0 || npc->x() > 500 || npc->y() < 0 || npc->y() > 500) return false;
 
     std::lock_guard<std::shared_mutex> guard(pimpl_->npcs_mutex);
-    auto it = std::find_if(pimpl_->npcs.begin(), pimpl_->npcs.end(),
-                           [&](const std::shared_ptr<NPCBase> &p){ return p->name() == npc->name(); });
-    if (it != pimpl_->npcs.end()) return false;
+    auto &world = pimpl_->world;
+    if (!pimpl_->inBounds(npc->x(), npc->y())) return false;
+    if (world.find(npc->name()) != kNoNPC) return false;
 
-    std::shared_ptr<NPCBase> sp(std::move(npc));
-    pimpl_->npcs.push_back(std::move(sp));
+    world.add(*npc);
+    ++pimpl_->world_version;
+    ++pimpl_->world_edits;
     return true;
 }
 
 bool Dungeon::loadFromFile(const std::string &fname) {
-    std::ifstream f(fname);
-    if (!f) return false;
-    std::string line;
-    std::vector<std::shared_ptr<NPCBase>> newlist;
-    while (std::getline(f, line)) {
-        if (line.empty()) continue;
-        auto up = NPCFactory::createFromLine(line);
-        if (!up) continue;
-        if (up->x() < 0 || up->x() > 500 || up->y() < 0 || up->y() > 500) continue;
-        bool dup = std::any_of(newlist.begin(), newlist.end(), [&](auto &p){ return p->name() == up->name(); });
-        if (dup) continue;
-        newlist.push_back(std::shared_ptr<NPCBase>(std::move(up)));
+    double world_w, world_h;
+    {
+        std::shared_lock<std::shared_mutex> sguard(pimpl_->npcs_mutex);
+        world_w = pimpl_->world_w;
+        world_h = pimpl_->world_h;
     }
+    auto inside = [&](double x, double y) { return x >= 0 && x <= world_w && y >= 0 && y <= world_h; };
+
+    WorldStore newworld;
+    if (snapshot::isSnapshot(fname)) {
+        snapshot::MappedSnapshot snap;
+        if (!snap.open(fname)) return false;
+        newworld.reserve(snap.size());
+        for (std::size_t i = 0; i < snap.size(); ++i) {
+            const auto e = snap.entry(i);
+            if (!inside(e.x, e.y)) continue;
+            if (newworld.find(e.name) != kNoNPC) continue;
+            NPCId id = newworld.add(e.type, std::string(e.name), e.x, e.y);
+            if (!e.alive) newworld.markDead(id);
+        }
+    } else if (snapshot::isCompressed(fname)) {
+        snapshot::CompressedSnapshot snap;
+        if (!snap.open(fname)) return false;
+        newworld.reserve(snap.size());
+        // ошибка квантования не должна выталкивать NPC у края за границу мира
+        const double slack = snap.step();
+        snapshot::CompressedSnapshot::Entry e;
+        while (snap.next(e)) {
+            if (e.x < 0 && e.x >= -slack) e.x = 0;
+            if (e.y < 0 && e.y >= -slack) e.y = 0;
+            if (e.x > world_w && e.x <= world_w + slack) e.x = world_w;
+            if (e.y > world_h && e.y <= world_h + slack) e.y = world_h;
+            if (!inside(e.x, e.y)) continue;
+            if (newworld.find(e.name) != kNoNPC) continue;
+            NPCId id = newworld.add(e.type, std::string(e.name), e.x, e.y);
+            if (!e.alive) newworld.markDead(id);
+        }
+        if (snap.failed()) return false;
+    } else {
+        // страницы читаются с диска, пока исполнители разбирают уже прочитанные
+        MappedFile file;
+        if (!file.open(fname)) return false;
+        const std::string_view text = file.text();
+
+        // Куски, выровненные по концу строки; разбор и фильтр границ — параллельно.
+        // Кусков больше, чем исполнителей: освободившийся исполнитель берёт следующий.
+        WorkerPool &pool = pimpl_->workers();
+        const std::size_t parts =
+            std::clamp<std::size_t>(text.size() / kLoadChunkBytes, 1, pool.size() * kLoadChunksPerWorker);
+        std::vector<std::size_t> cut(parts + 1, text.size());
+        cut[0] = 0;
+        for (std::size_t k = 1; k < parts; ++k) {
+            std::size_t pos = std::max(cut[k - 1], text.size() * k / parts);
+            pos = text.find('\n', pos);
+            cut[k] = pos == std::string_view::npos ? text.size() : pos + 1;
+        }
+
+        std::vector<std::vector<NPCSpec>> specs(parts);
+        std::atomic<std::size_t> next_part{0};
+        pool.parallelFor(std::min(parts, pool.size()), 1, [&](std::size_t, std::size_t, std::size_t) {
+            for (std::size_t k; (k = next_part.fetch_add(1, std::memory_order_relaxed)) < parts;) {
+                auto &out = specs[k];
+                NPCFactory::parseBuffer(text.substr(cut[k], cut[k + 1] - cut[k]), out);
+                out.erase(std::remove_if(out.begin(), out.end(), [&](const NPCSpec &s) { return !inside(s.x, s.y); }),
+                          out.end());
+            }
+        });
+
+        // слияние по порядку кусков: первое вхождение имени побеждает
+        std::size_t total = 0;
+        for (const auto &chunk : specs) total += chunk.size();
+        newworld.reserve(total);
+        for (auto &chunk : specs) {
+            for (NPCSpec &s : chunk) {
+                if (newworld.find(s.name) != kNoNPC) continue;
+                newworld.add(s.type, std::move(s.name), s.x, s.y);
+            }
+            std::vector<NPCSpec>().swap(chunk);
+        }
+    }
+
     {
         std::lock_guard<std::shared_mutex> guard(pimpl_->npcs_mutex);
-        pimpl_->npcs = std::move(newlist);
+        pimpl_->world = std::move(newworld);
+        ++pimpl_->world_epoch;
+        ++pimpl_->world_version;
+        ++pimpl_->world_edits;
+        pimpl_->tick = 0;
     }
     return true;
 }
 
-bool Dungeon::saveToFile(const std::string &fname) const {
+bool Dungeon::saveToFile(const std::string &fname, WorldFormat format, double quantum) const {
+    // медленная запись не держит блокировку мира: пишется опубликованный кадр
+    const auto view = pimpl_->currentFrame();
+    const WorldFrame &world = *view;
+    if (format == WorldFormat::Binary) return snapshot::write(fname, world);
+    if (format == WorldFormat::Compressed) return snapshot::writeCompressed(fname, world, quantum);
+
     std::ofstream f(fname);
     if (!f) return false;
-    std::shared_lock<std::shared_mutex> sguard(pimpl_->npcs_mutex);
-    for (auto &p : pimpl_->npcs) {
-        f << p->type() << " " << p->name() << " " << p->x() << " " << p->y() << "\n";
+    for (NPCId id = 0; id < world.size(); ++id) {
+        f << typeName(world.type(id)) << " " << world.name(id) << " " << world.x(id) << " " << world.y(id) << "\n";
     }
     return true;
 }
 
 void Dungeon::clear() noexcept {
     std::lock_guard<std::shared_mutex> guard(pimpl_->npcs_mutex);
-    pimpl_->npcs.clear();
+    pimpl_->world.clear();
+    ++pimpl_->world_epoch;
+    ++pimpl_->world_version;
+    ++pimpl_->world_edits;
+    pimpl_->tick = 0;
 }
 
-void Dungeon::printAll() const {
-    constexpr int GRID_W = 10;
-    constexpr int GRID_H = 10;
-    constexpr double COORD_MAX = 100.0;
+bool Dungeon::setWorldSize(double width, double height) {
+    if (!(width > 0) || !(height > 0) || !std::isfinite(width) || !std::isfinite(height)) return false;
+    std::lock_guard<std::shared_mutex> guard(pimpl_->npcs_mutex);
+    pimpl_->world_w = width;
+    pimpl_->world_h = height;
+    ++pimpl_->world_version;
+    ++pimpl_->world_edits;
+    return true;
+}
 
-    std::vector<std::string> grid(GRID_H, std::string(GRID_W, ' '));
-    int alive_count = 0;
+double Dungeon::worldWidth() const noexcept {
+    std::shared_lock<std::shared_mutex> sguard(pimpl_->npcs_mutex);
+    return pimpl_->world_w;
+}
 
-    {
-        std::shared_lock<std::shared_mutex> lock(pimpl_->npcs_mutex);
-        for (const auto &p : pimpl_->npcs) {
-            if (!p) continue;
-            if (!p->alive()) continue;
-            ++alive_count;
+double Dungeon::worldHeight() const noexcept {
+    std::shared_lock<std::shared_mutex> sguard(pimpl_->npcs_mutex);
+    return pimpl_->world_h;
+}
 
-            int gx = static_cast<int>(p->x() / COORD_MAX * GRID_W);
-            int gy = static_cast<int>(p->y() / COORD_MAX * GRID_H);
+// символы типов на карте, в порядке NPCType
+static constexpr char kTypeSymbol[kNPCTypeCount] = {'O', 'B', 'S', 'b', 'W'};
 
-            if (gx < 0) gx = 0;
-            if (gy < 0) gy = 0;
-            if (gx >= GRID_W) gx = GRID_W - 1;
-            if (gy >= GRID_H) gy = GRID_H - 1;
+namespace {
 
-            char symbol = '?';
-            std::string t = p->type();
-            if (t == "Bear" || t == "bear") symbol = 'B';
-            else if (t == "Bandit" || t == "bandit") symbol = 'b';
-            else if (t == "Orc" || t == "orc") symbol = 'O';
-            else if (t == "Werewolf" || t == "werewolf") symbol = 'W';
-            else if (t == "Squirrel" || t == "squirrel") symbol = 'S';
-            else symbol = t.empty() ? '?' : t[0];
+void appendNumber(std::string &out, std::size_t v) {
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, res.ptr);
+}
+
+// ESC [ row ; col H, нумерация с 1
+void appendCursor(std::string &out, std::size_t row, std::size_t col) {
+    out += "\x1b[";
+    appendNumber(out, row);
+    out += ';';
+    appendNumber(out, col);
+    out += 'H';
+}
+
+}
+
+// Кадр в frame. Строка 1 — заголовок, строка 2 + y — клетки, символ клетки x в столбце 3x + 2.
+void Dungeon::Impl::renderFrame(const WorldFrame &wf) {
+    if (render_mode == RenderMode::Density || render_mode == RenderMode::DominantType) {
+        renderHeatmap(wf);
+        return;
+    }
+    const std::size_t gw = grid_w, gh = grid_h;
+    cells.assign(gw * gh, ' ');
+    std::size_t alive_count = 0;
 
-            char &cell = grid[gy][gx];
+    {
+        const double sx = static_cast<double>(gw) / wf.width;
+        const double sy = static_cast<double>(gh) / wf.height;
+        for (NPCId id = 0; id < wf.size(); ++id) {
+            if (!wf.alive(id)) continue;
+            ++alive_count;
+
+            const double fx = wf.x(id) * sx;
+            const double fy = wf.y(id) * sy;
+            const std::size_t gx = fx <= 0 ? 0 : std::min(static_cast<std::size_t>(fx), gw - 1);
+            const std::size_t gy = fy <= 0 ? 0 : std::min(static_cast<std::size_t>(fy), gh - 1);
+
+            const char symbol = kTypeSymbol[static_cast<std::size_t>(wf.type(id))];
+            char &cell = cells[gy * gw + gx];
             if (cell == ' ') cell = symbol;
-            else if (cell == symbol) {}
-            else cell = '*';
+            else if (cell != symbol) cell = '*';
         }
     }
 
+    frame.clear();
+    const bool diff = render_mode == RenderMode::AnsiDiff;
+    if (diff && prev_cells.size() == cells.size()) {
+        appendCursor(frame, 1, 1);
+        frame += "--- NPCs (";
+        appendNumber(frame, alive_count);
+        frame += ") ---\x1b[K";
+        for (std::size_t y = 0; y < gh; ++y) {
+            std::size_t cursor_col = 0;   // 0 — позиция курсора в строке неизвестна
+            for (std::size_t x = 0; x < gw; ++x) {
+                const std::size_t i = y * gw + x;
+                if (cells[i] == prev_cells[i]) continue;
+                const std::size_t col = 3 * x + 2;
+                if (cursor_col && col - cursor_col <= 3) {
+                    // короткий сдвиг вправо вместо полной позиции
+                    if (col > cursor_col) {
+                        frame += "\x1b[";
+                        appendNumber(frame, col - cursor_col);
+                        frame += 'C';
+                    }
+                } else {
+                    appendCursor(frame, y + 2, col);
+                }
+                frame += cells[i];
+                cursor_col = col + 1;
+            }
+        }
+        appendCursor(frame, gh + 2, 1);
+    } else {
+        frame.reserve(32 + gh * (3 * gw + 1));
+        if (diff) frame += "\x1b[2J\x1b[H";
+        frame += "--- NPCs (";
+        appendNumber(frame, alive_count);
+        frame += ") ---";
+        if (diff) frame += "\x1b[K";
+        frame += '\n';
+        for (std::size_t y = 0; y < gh; ++y) {
+            for (std::size_t x = 0; x < gw; ++x) {
+                frame += '[';
+                frame += cells[y * gw + x];
+                frame += ']';
+            }
+            frame += '\n';
+        }
+    }
+    if (diff) prev_cells.swap(cells);
+}
+
+// минимальный кусок NPC на исполнителя при построении гистограммы
+static constexpr std::size_t kHeatmapChunk = 8192;
+// оттенки плотности от пустой клетки к самой заполненной
+static constexpr char kShades[] = " .:-=+*#%@";
+
+// Тепловая карта: один символ на клетку. Гистограммы строятся параллельно
+// по диапазонам NPC кадра, затем сливаются по диапазонам клеток.
+void Dungeon::Impl::renderHeatmap(const WorldFrame &wf) {
+    const std::size_t gw = grid_w, gh = grid_h;
+    const std::size_t bins = gw * gh * kNPCTypeCount;
+    WorkerPool &pool = renderWorkers();
+    partial_hist.resize(pool.size());
+    std::vector<std::size_t> alive_per_worker(pool.size(), 0);
+    std::vector<std::uint8_t> used(pool.size(), 0);
+
     {
-        std::lock_guard<std::mutex> cout_lock(coutMutex());
-        std::cout << "--- NPCs (" << alive_count << ") ---\n";
+        const std::size_t n = wf.size();
+        const double* xs = wf.xs.data();
+        const double* ys = wf.ys.data();
+        const NPCType* types = wf.types.data();
+        const std::uint8_t* alive = wf.aliveFlags.data();
+        const double sx = static_cast<double>(gw) / wf.width;
+        const double sy = static_cast<double>(gh) / wf.height;
 
-        for (int y = 0; y < GRID_H; ++y) {
-            for (int x = 0; x < GRID_W; ++x) {
-                std::cout << "[" << grid[y][x] << "]";
+        pool.parallelFor(n, kHeatmapChunk, [&](std::size_t begin, std::size_t end, std::size_t w) {
+            auto &h = partial_hist[w];
+            h.assign(bins, 0);
+            used[w] = 1;
+            std::size_t count = 0;
+            for (std::size_t i = begin; i < end; ++i) {
+                if (!alive[i]) continue;
+                ++count;
+                const double fx = xs[i] * sx;
+                const double fy = ys[i] * sy;
+                const std::size_t gx = fx <= 0 ? 0 : std::min(static_cast<std::size_t>(fx), gw - 1);
+                const std::size_t gy = fy <= 0 ? 0 : std::min(static_cast<std::size_t>(fy), gh - 1);
+                ++h[(gy * gw + gx) * kNPCTypeCount + static_cast<std::size_t>(types[i])];
             }
-            std::cout << '\n';
+            alive_per_worker[w] = count;
+        });
+    }
+
+    // слияние частичных гистограмм по диапазонам клеток
+    hist.assign(bins, 0);
+    pool.parallelFor(bins, kHeatmapChunk, [&](std::size_t begin, std::size_t end, std::size_t) {
+        for (std::size_t w = 0; w < partial_hist.size(); ++w) {
+            if (!used[w]) continue;
+            const std::uint32_t* h = partial_hist[w].data();
+            for (std::size_t b = begin; b < end; ++b) hist[b] += h[b];
         }
-        std::cout << std::flush;
+    });
+
+    std::size_t alive_count = 0;
+    for (std::size_t c : alive_per_worker) alive_count += c;
+    std::uint32_t max_cell = 0;
+    for (std::size_t c = 0; c < gw * gh; ++c) {
+        std::uint32_t total = 0;
+        for (std::size_t t = 0; t < kNPCTypeCount; ++t) total += hist[c * kNPCTypeCount + t];
+        max_cell = std::max(max_cell, total);
+    }
+
+    frame.clear();
+    frame.reserve(32 + gh * (gw + 1));
+    frame += "--- NPCs (";
+    appendNumber(frame, alive_count);
+    frame += ") ---\n";
+    constexpr std::size_t levels = sizeof(kShades) - 2;
+    for (std::size_t y = 0; y < gh; ++y) {
+        for (std::size_t x = 0; x < gw; ++x) {
+            const std::uint32_t* h = hist.data() + (y * gw + x) * kNPCTypeCount;
+            std::uint32_t total = 0, best = 0;
+            std::size_t best_type = 0;
+            for (std::size_t t = 0; t < kNPCTypeCount; ++t) {
+                total += h[t];
+                if (h[t] > best) {
+                    best = h[t];
+                    best_type = t;
+                }
+            }
+            if (total == 0) frame += ' ';
+            else if (render_mode == RenderMode::DominantType) frame += kTypeSymbol[best_type];
+            else frame += kShades[1 + (static_cast<std::size_t>(total) * levels - 1) / max_cell];
+        }
+        frame += '\n';
+    }
+}
+
+void Dungeon::printAll() const {
+    const auto view = pimpl_->currentFrame();
+    std::lock_guard<std::mutex> render_lock(pimpl_->render_mutex);
+    pimpl_->renderFrame(*view);
+
+    // весь кадр — одна запись под мьютексом вывода
+    std::lock_guard<std::mutex> cout_lock(coutMutex());
+    std::cout.write(pimpl_->frame.data(), static_cast<std::streamsize>(pimpl_->frame.size()));
+    std::cout.flush();
+}
+
+std::string Dungeon::renderAll() const {
+    const auto view = pimpl_->currentFrame();
+    std::lock_guard<std::mutex> render_lock(pimpl_->render_mutex);
+    pimpl_->renderFrame(*view);
+    return pimpl_->frame;
+}
+
+void Dungeon::setRenderMode(RenderMode mode) {
+    std::lock_guard<std::mutex> render_lock(pimpl_->render_mutex);
+    pimpl_->render_mode = mode;
+    pimpl_->prev_cells.clear();
+}
+
+bool Dungeon::setRenderGrid(std::size_t width, std::size_t height) {
+    if (width == 0 || height == 0) return false;
+    std::lock_guard<std::mutex> render_lock(pimpl_->render_mutex);
+    pimpl_->grid_w = width;
+    pimpl_->grid_h = height;
+    pimpl_->prev_cells.clear();
+    return true;
+}
+
+bool Dungeon::setSeed(std::uint64_t seed) {
+    if (pimpl_->movement_thread.joinable() || pimpl_->battle_thread.joinable()) return false;
+    std::lock_guard<std::shared_mutex> guard(pimpl_->npcs_mutex);
+    pimpl_->seed = seed;
+    pimpl_->seeded = true;
+    pimpl_->tick = 0;
+    return true;
+}
+
+bool Dungeon::setWorkerCount(std::size_t n) {
+    if (pimpl_->movement_thread.joinable()) return false;
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->pool_mutex);
+        pimpl_->worker_count = n;
+        pimpl_->pool.reset();
+    }
+    std::lock_guard<std::mutex> render_lock(pimpl_->render_mutex);
+    pimpl_->render_pool.reset();
+    return true;
+}
+
+std::size_t Dungeon::workerCount() {
+    return pimpl_->workers().size();
+}
+
+std::unique_ptr<NPCBase> Dungeon::findNPC(const std::string &name) const {
+    const auto view = pimpl_->currentFrame();
+    const NPCId id = view->find(name);
+    if (id == kNoNPC) return nullptr;
+    return view->materialize(id);
+}
+
+std::size_t Dungeon::aliveCount() const {
+    return pimpl_->currentFrame()->aliveCount;
+}
+
+std::shared_ptr<const WorldFrame> Dungeon::frame() const {
+    return pimpl_->currentFrame();
+}
+
+bool Dungeon::startJournal(const std::string &basePath) {
+    std::lock_guard<std::mutex> jguard(pimpl_->journal_mutex);
+    std::lock_guard<std::shared_mutex> guard(pimpl_->npcs_mutex);
+    auto &journal = pimpl_->journal;
+    journal.snap_path = basePath + ".snap";
+    journal.log_path = basePath + ".journal";
+    journal.active = pimpl_->journalRebase();
+    return journal.active;
+}
+
+bool Dungeon::checkpoint() {
+    std::lock_guard<std::mutex> jguard(pimpl_->journal_mutex);
+    auto &journal = pimpl_->journal;
+    journal::Frame frame;
+    {
+        std::lock_guard<std::shared_mutex> guard(pimpl_->npcs_mutex);
+        if (!journal.active) return false;
+        // после clear/load/уплотнения идентификаторы NPC другие — только новый снимок
+        if (journal.epoch != pimpl_->world_epoch || journal.layout != pimpl_->layout) return pimpl_->journalRebase();
+        pimpl_->journalCollect(frame);
     }
+    if (frame.empty()) return true;
+    if (!frame.appendTo(journal.log_path)) return false;
+    journal.journal_bytes += sizeof(journal::FrameHeader) + frame.size();
+
+    if (journal.journal_bytes > kJournalCompactRatio * journal.snapshot_bytes) {
+        std::lock_guard<std::shared_mutex> guard(pimpl_->npcs_mutex);
+        return pimpl_->journalRebase();
+    }
+    return true;
+}
+
+void Dungeon::stopJournal() {
+    std::lock_guard<std::mutex> jguard(pimpl_->journal_mutex);
+    std::lock_guard<std::shared_mutex> guard(pimpl_->npcs_mutex);
+    pimpl_->journal = Impl::Journal{};
+}
+
+bool Dungeon::loadJournal(const std::string &basePath) {
+    WorldStore newworld;
+    if (!snapshot::read(basePath + ".snap", newworld)) return false;
+    journal::replay(basePath + ".journal", newworld);
+
+    std::lock_guard<std::shared_mutex> guard(pimpl_->npcs_mutex);
+    pimpl_->world = std::move(newworld);
+    ++pimpl_->world_epoch;
+    ++pimpl_->world_version;
+    ++pimpl_->world_edits;
+    pimpl_->tick = 0;
+    return true;
 }
 
 EventManager& Dungeon::events() noexcept {
     return pimpl_->events;
 }
 
-static bool checkKillByType(const std::string &A, const std::string &B) {
-    if (A == "Orc") return (B == "Bear" || B == "Orc" || B == "Bandit");
-    if (A == "Bear") return (B == "Squirrel");
-    if (A == "Squirrel") return false;
-    if (A == "Bandit") return (B == "Werewolf");
-    if (A == "Werewolf") return (B == "Bandit");
-    return false;
+std::shared_ptr<const WorldFrame> Dungeon::Impl::publish(WorkerPool *pool) {
+    std::lock_guard<std::mutex> plock(publish_mutex);
+    if (live_frame && live_frame->version == world_version.load()) return live_frame;
+
+    std::unique_ptr<WorldFrame> buffers;
+    {
+        std::lock_guard<std::mutex> lock(recycler->mutex);
+        buffers = std::move(recycler->spare);
+    }
+    if (!buffers) buffers = std::make_unique<WorldFrame>();
+    std::shared_ptr<WorldFrame> f(buffers.release(), [r = recycler](WorldFrame *p) {
+        std::unique_ptr<WorldFrame> old;
+        std::lock_guard<std::mutex> lock(r->mutex);
+        old = std::move(r->spare);
+        r->spare.reset(p);
+    });
+    std::uint64_t edits;
+    {
+        std::shared_lock<std::shared_mutex> lock(npcs_mutex);
+        const std::size_t n = world.size();
+        // типы не меняются в пределах раскладки: у переиспользуемого кадра копируется хвост
+        const std::size_t types_kept =
+            f->epoch == world_epoch && f->layout == layout ? std::min(f->types.size(), n) : 0;
+        edits = world_edits.load();
+        f->tick = tick;
+        f->epoch = world_epoch;
+        f->version = world_version.load();
+        f->width = world_w;
+        f->height = world_h;
+        f->xs.resize(n);
+        f->ys.resize(n);
+        f->types.resize(n);
+        f->aliveFlags.resize(n);
+        f->layout = layout;
+
+        // блокировка мира держится только на время копирования
+        auto copy = [&](std::size_t begin, std::size_t end, std::size_t) {
+            std::copy(world.xs() + begin, world.xs() + end, f->xs.data() + begin);
+            std::copy(world.ys() + begin, world.ys() + end, f->ys.data() + begin);
+            std::copy(world.aliveFlags() + begin, world.aliveFlags() + end, f->aliveFlags.data() + begin);
+            const std::size_t from = std::max(begin, types_kept);
+            if (from < end) std::copy(world.types() + from, world.types() + end, f->types.data() + from);
+        };
+        if (pool) pool->parallelFor(n, kFrameChunk, copy);
+        else copy(0, n, 0);
+
+        const bool same_world = live_frame && live_frame->epoch == world_epoch && live_frame->layout == layout;
+        f->names = NameTable::extend(same_world ? live_frame->names : nullptr, world);
+    }
+    f->aliveCount = static_cast<std::size_t>(std::count(f->aliveFlags.begin(), f->aliveFlags.end(), 1));
+
+    live_frame = f;
+    std::shared_ptr<const WorldFrame> previous;   // отпускается вне frame_mutex
+    {
+        std::lock_guard<std::mutex> lock(frame_mutex);
+        previous = std::move(published);
+        published = f;
+        published_edits = edits;
+    }
+    return f;
+}
+
+std::shared_ptr<const WorldFrame> Dungeon::Impl::currentFrame() {
+    std::shared_ptr<const WorldFrame> f;
+    std::uint64_t edits;
+    {
+        std::lock_guard<std::mutex> lock(frame_mutex);
+        f = published;
+        edits = published_edits;
+    }
+    // во время симуляции кадр отстаёт не больше чем на тик, но не на правку мира
+    if (f && (sim_running.load() ? edits == world_edits.load() : f->version == world_version.load())) return f;
+    return publish();
+}
+
+void Dungeon::Impl::pickSeed() {
+    if (!seeded) seed = static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+}
+
+// Мёртвые NPC удаляются из колонок, и проходы тика идут только по живым.
+// Бои в очереди держат описатели и разрешаются после уплотнения.
+// Под эксклюзивной блокировкой мира.
+void Dungeon::Impl::compactIfNeeded() {
+    if (compact_min_dead == 0) return;
+    const std::size_t n = world.size();
+    const std::size_t alive = static_cast<std::size_t>(std::count(world.aliveFlags(), world.aliveFlags() + n, 1));
+    const std::size_t dead = n - alive;
+    if (dead < compact_min_dead || dead * 4 < n) return;
+    compacted += world.compact();
+    ++layout;
+}
+
+// Шаг перемещения всех живых NPC; возвращает номер тика.
+// Под эксклюзивной блокировкой мира.
+std::uint64_t Dungeon::Impl::moveTick(WorkerPool &pool) {
+    std::lock_guard<std::shared_mutex> lg(npcs_mutex);
+    const std::uint64_t t = tick++;
+    ++world_version;
+    compactIfNeeded();
+    const double w_max = world_w;
+    const double h_max = world_h;
+    const std::uint64_t s = seed;
+    const std::size_t n = world.size();
+    const std::uint8_t* alive = world.aliveFlags();
+    const double* moves = world.moveDistances();
+    const NPCHandle* handles = world.handles();
+    double* xs = world.xs();
+    double* ys = world.ys();
+
+    // журнал отмечает сдвинувшихся: флаг на NPC и список на исполнителя
+    const bool track = journal.active && journal.epoch == world_epoch && journal.layout == layout;
+    if (track) journal.moved.resize(std::max(journal.moved.size(), pool.size()));
+    std::uint8_t* dirty = track ? journal.dirty.data() : nullptr;
+    const std::size_t synced = journal.synced;
+
+    pool.parallelFor(n, kMoveChunk, [&](std::size_t begin, std::size_t end, std::size_t w) {
+        for (std::size_t i = begin; i < end; ++i) {
+            if (!alive[i]) continue;
+
+            double md = moves[i];
+
+            double theta = 2.0 * M_PI * simrng::unit(simrng::draw(s, simrng::kMove, t, handles[i]));
+            double nx = xs[i] + md * std::cos(theta);
+            double ny = ys[i] + md * std::sin(theta);
+
+            if (nx < 0.0) nx = 0.0;
+            if (nx > w_max) nx = w_max;
+            if (ny < 0.0) ny = 0.0;
+            if (ny > h_max) ny = h_max;
+
+            xs[i] = nx;
+            ys[i] = ny;
+
+            if (dirty && i < synced && !dirty[i]) {
+                dirty[i] = 1;
+                journal.moved[w].push_back(static_cast<NPCId>(i));
+            }
+        }
+    });
+    return t;
+}
+
+// Поиск враждебных пар в радиусе; результат — в tick_fights.
+void Dungeon::Impl::detectFights(std::uint64_t t) {
+    std::shared_lock<std::shared_mutex> sguard(npcs_mutex);
+    const std::size_t n = world.size();
+    const double* xs = world.xs();
+    const double* ys = world.ys();
+    const double* kds = world.killDistances();
+    const NPCType* types = world.types();
+    const std::uint8_t* alive = world.aliveFlags();
+    const NPCHandle* handles = world.handles();
+    const std::uint64_t epoch = world_epoch;
+    tick_fights.clear();
+
+    double kd_max = 0.0;
+    for (std::size_t i = 0; i < n; ++i) kd_max = std::max(kd_max, kds[i]);
+
+    grid.rebuild(xs, ys, n, kd_max, alive, kds);
+#ifndef NDEBUG
+    seen_in_tick.reset();
+#endif
+
+    // сетка выдаёт каждую пару ровно один раз (i < j), повторов нет
+    grid.forEachPairInRange([&](NPCId a, NPCId b) {
+        if (!isHostilePair(types[a], types[b])) return;
+#ifndef NDEBUG
+        const bool fresh = seen_in_tick.insert(a, b);
+        assert(fresh);
+#endif
+        tick_fights.push_back({handles[a], handles[b], epoch, t});
+    });
+}
+
+TickStats Dungeon::runTicks(std::uint64_t n) {
+    TickStats stats;
+    if (pimpl_->movement_thread.joinable() || pimpl_->battle_thread.joinable()) return stats;
+
+    std::lock_guard<std::mutex> step_lock(pimpl_->step_mutex);
+    WorkerPool &pool = pimpl_->workers();
+    pimpl_->pickSeed();
+    std::vector<DeathEvent> deaths;
+
+    const auto started = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < n; ++i) {
+        const std::uint64_t tick = pimpl_->moveTick(pool);
+        pimpl_->detectFights(tick);
+
+        // те же пачки, что забирает поток боя: журнал смертей совпадает с потоковым прогоном
+        const auto &fights = pimpl_->tick_fights;
+        for (std::size_t done = 0; done < fights.size(); done += kFightBatch) {
+            const std::size_t count = std::min(kFightBatch, fights.size() - done);
+            deaths.clear();
+            {
+                std::lock_guard<std::shared_mutex> lg(pimpl_->npcs_mutex);
+                pimpl_->resolveFights(fights.data() + done, count, deaths);
+            }
+            for (const auto &ev : deaths) pimpl_->events.notify(ev);
+            stats.deaths += deaths.size();
+        }
+        stats.fights += fights.size();
+        ++stats.ticks;
+        pimpl_->publish();
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    if (stats.seconds > 0.0) stats.ticksPerSecond = static_cast<double>(stats.ticks) / stats.seconds;
+    return stats;
+}
+
+CombatSummary Dungeon::runCombat(double range) {
+    CombatSummary summary;
+    if (!(range > 0.0) || !std::isfinite(range)) return summary;
+    if (pimpl_->movement_thread.joinable() || pimpl_->battle_thread.joinable()) return summary;
+
+    std::lock_guard<std::mutex> step_lock(pimpl_->step_mutex);
+    pimpl_->pickSeed();
+    std::vector<DeathEvent> deaths;
+    {
+        std::lock_guard<std::shared_mutex> lg(pimpl_->npcs_mutex);
+        auto &world = pimpl_->world;
+        const std::size_t n = world.size();
+        const NPCType* types = world.types();
+        // раунд занимает номер тика: кости не совпадают с боями соседних тиков
+        const std::uint64_t tick = pimpl_->tick++;
+        const std::uint64_t epoch = pimpl_->world_epoch;
+
+        auto &radii = pimpl_->combat_radii;
+        radii.assign(n, range);
+        pimpl_->grid.rebuild(world.xs(), world.ys(), n, range, world.aliveFlags(), radii.data());
+
+        // порядок пар задаёт сетка и зависит только от координат;
+        // волны сохраняют его для боёв с общими NPC
+        auto &fights = pimpl_->tick_fights;
+        fights.clear();
+        pimpl_->grid.forEachPairInRange([&](NPCId a, NPCId b) {
+            if (isHostilePair(types[a], types[b])) fights.push_back({world.handle(a), world.handle(b), epoch, tick});
+        });
+
+        pimpl_->resolveFights(fights.data(), fights.size(), deaths, range);
+        summary.pairs = fights.size();
+        summary.waves = pimpl_->last_waves;
+        for (NPCId id = 0; id < n; ++id) summary.alive += world.alive(id);
+    }
+    for (const auto &ev : deaths) pimpl_->events.notify(ev);
+    summary.deaths = deaths.size();
+    pimpl_->publish();
+    return summary;
 }
 
 void Dungeon::startSimulation(int seconds) {
@@ -161,135 +1107,64 @@ void Dungeon::startSimulation(int seconds) {
 
     pimpl_->stop_flag.store(false);
 
+    WorkerPool &pool = pimpl_->workers();
+    pimpl_->pickSeed();
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->tick_mutex);
+        pimpl_->fights_pushed = 0;
+        pimpl_->fights_resolved = 0;
+    }
+
+    // до запуска потока: cancel() из stopSimulation не потеряется
+    pimpl_->scheduler.start();
+    // читатели берут кадры, опубликованные потоком перемещений
+    pimpl_->publish();
+    pimpl_->sim_running.store(true);
+
     // поток перемещений
-    pimpl_->movement_thread = std::thread([this]() {
-        thread_local std::mt19937 rng((unsigned)std::chrono::system_clock::now().time_since_epoch().count());
-        std::uniform_real_distribution<double> ang(0.0, 2.0 * M_PI);
-        const int tick_ms = 200;
+    pimpl_->movement_thread = std::thread([this, &pool]() {
+        while (!pimpl_->stop_flag.load() && pimpl_->scheduler.waitNext()) {
+            const std::uint64_t tick = pimpl_->moveTick(pool);
+            pimpl_->detectFights(tick);
 
-        while (!pimpl_->stop_flag.load()) {
-            {
-                std::lock_guard<std::shared_mutex> lg(pimpl_->npcs_mutex);
-                for (auto &p : pimpl_->npcs) {
-                    if (!p || !p->alive()) continue;
-                    
-                    int md = p->moveDistance();
-                    
-                    double theta = ang(rng);
-                    double nx = p->x() + md * std::cos(theta);
-                    double ny = p->y() + md * std::sin(theta);
-                    
-                    if (nx < 0.0) nx = 0.0; 
-                    if (nx > 100.0) nx = 100.0;
-                    if (ny < 0.0) ny = 0.0; 
-                    if (ny > 100.0) ny = 100.0;
-                    
-                    p->setPosition(nx, ny);
-                }
-            }
+            // без блокировки мира: при полной очереди ждём поток боя
+            const std::size_t pushed =
+                pimpl_->fight_queue.pushBatch(pimpl_->tick_fights.data(), pimpl_->tick_fights.size(), pimpl_->stop_flag);
+            pimpl_->fights_pushed += pushed;
 
-            {
-                std::shared_lock<std::shared_mutex> sguard(pimpl_->npcs_mutex);
-                size_t n = pimpl_->npcs.size();
-                std::set<std::pair<std::string,std::string>> seen_in_tick;
-
-                for (size_t i = 0; i < n; ++i) {
-                    auto A = pimpl_->npcs[i];
-                    if (!A || !A->alive()) continue;
-
-                    for (size_t j = i+1; j < n; ++j) {
-                        auto B = pimpl_->npcs[j];
-                        if (!B || !B->alive()) continue;
-
-                        double dx = A->x() - B->x();
-                        double dy = A->y() - B->y();
-                        double dist2 = dx*dx + dy*dy;
-                        
-                        double kdA = A->killDistance();
-                        double kdB = B->killDistance();
-                        double maxkd = std::max(kdA, kdB);
-
-                        if (dist2 <= maxkd * maxkd) {
-                            bool A_kills_B = checkKillByType(A->type(), B->type());
-                            bool B_kills_A = checkKillByType(B->type(), A->type());
-
-                            if (!A_kills_B && !B_kills_A) continue;
-
-                            auto key = (A->name() < B->name()) ? std::make_pair(A->name(), B->name())
-                                                               : std::make_pair(B->name(), A->name());
-                            
-                            if (seen_in_tick.find(key) == seen_in_tick.end()) {
-                                seen_in_tick.insert(key);
-                                {
-                                    std::lock_guard<std::mutex> ql(pimpl_->queue_mutex);
-                                    pimpl_->fight_queue.emplace_back(A, B);
-                                }
-                                pimpl_->queue_cv.notify_one();
-                            }
-                        }
-                    }
-                }
+            // барьер тика: следующее перемещение — только после всех боёв этого тика
+            if (pimpl_->seeded) {
+                std::unique_lock<std::mutex> lock(pimpl_->tick_mutex);
+                pimpl_->tick_cv.wait(lock, [this]() {
+                    return pimpl_->fights_resolved >= pimpl_->fights_pushed || pimpl_->stop_flag.load();
+                });
             }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(tick_ms));
+            pimpl_->publish(&pool);
+            pimpl_->scheduler.endTick();
         }
     });
 
-    // поток боя
+    // поток боя: забирает пачку из очереди и раздаёт её исполнителям пула
     pimpl_->battle_thread = std::thread([this]() {
-        thread_local std::mt19937 rng((unsigned)std::chrono::system_clock::now().time_since_epoch().count() + 12345);
-        std::uniform_int_distribution<int> die(1,6);
+        std::vector<Impl::Fight> batch(kFightBatch);
+        std::vector<DeathEvent> deaths;
 
         while (!pimpl_->stop_flag.load()) {
-            std::pair<std::shared_ptr<NPCBase>, std::shared_ptr<NPCBase>> task;
-            
-            {
-                std::unique_lock<std::mutex> ql(pimpl_->queue_mutex);
-                pimpl_->queue_cv.wait(ql, [this](){ 
-                    return !pimpl_->fight_queue.empty() || pimpl_->stop_flag.load(); 
-                });
-                
-                if (pimpl_->stop_flag.load() && pimpl_->fight_queue.empty()) break;
-                
-                task = pimpl_->fight_queue.front();
-                pimpl_->fight_queue.pop_front();
-            }
-
-            auto A = task.first;
-            auto B = task.second;
-
-            std::lock_guard<std::shared_mutex> lg(pimpl_->npcs_mutex);
-            
-            if (!A->alive() || !B->alive()) continue;
-            
-            double dx = A->x() - B->x();
-            double dy = A->y() - B->y();
-            double dist2 = dx*dx + dy*dy;
-            double maxRange = std::max(A->killDistance(), B->killDistance());
-            if (dist2 > maxRange * maxRange) continue;
+            const std::size_t count = pimpl_->fight_queue.popBatch(batch.data(), batch.size(), pimpl_->stop_flag);
+            if (count == 0) break;
 
-            bool A_wins = false;
-            bool B_wins = false;
-
-            if (checkKillByType(A->type(), B->type())) {
-                if (die(rng) > die(rng)) A_wins = true;
-            }
-            if (checkKillByType(B->type(), A->type())) {
-                if (die(rng) > die(rng)) B_wins = true;
+            deaths.clear();
+            {
+                std::lock_guard<std::shared_mutex> lg(pimpl_->npcs_mutex);
+                pimpl_->resolveFights(batch.data(), count, deaths);
             }
-
-            if (A_wins && !B_wins) {
-                B->markDead();
-                pimpl_->events.notify({A->name(), B->name(), B->x(), B->y()});
-            } else if (B_wins && !A_wins) {
-                A->markDead();
-                pimpl_->events.notify({B->name(), A->name(), A->x(), A->y()});
-            } else if (A_wins && B_wins) {
-                A->markDead();
-                B->markDead();
-                pimpl_->events.notify({A->name(), B->name(), B->x(), B->y()});
-                pimpl_->events.notify({B->name(), A->name(), A->x(), A->y()});
+            for (const auto &ev : deaths) pimpl_->events.notify(ev);
+            {
+                std::lock_guard<std::mutex> lock(pimpl_->tick_mutex);
+                pimpl_->fights_resolved += count;
             }
+            pimpl_->tick_cv.notify_one();
         }
     });
 
@@ -303,7 +1178,13 @@ void Dungeon::startSimulation(int seconds) {
 
 void Dungeon::stopSimulation() {
     pimpl_->stop_flag.store(true);
-    pimpl_->queue_cv.notify_all();
+    pimpl_->sim_running.store(false);
+    pimpl_->scheduler.cancel();
+    pimpl_->fight_queue.wakeConsumer();
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->tick_mutex);
+    }
+    pimpl_->tick_cv.notify_all();
 }
 
 void Dungeon::joinSimulation() {
@@ -311,6 +1192,40 @@ void Dungeon::joinSimulation() {
     if (pimpl_->battle_thread.joinable()) pimpl_->battle_thread.join();
 }
 
+bool Dungeon::setTickRate(double ticksPerSecond, OverrunPolicy policy) {
+    if (!(ticksPerSecond > 0.0) || !std::isfinite(ticksPerSecond)) return false;
+    if (pimpl_->movement_thread.joinable()) return false;
+    const auto period = std::chrono::duration_cast<TickScheduler::Clock::duration>(
+        std::chrono::duration<double>(1.0 / ticksPerSecond));
+    return pimpl_->scheduler.configure(period, policy);
+}
+
+bool Dungeon::setTickClock(std::shared_ptr<TickClock> clock) {
+    if (pimpl_->movement_thread.joinable()) return false;
+    pimpl_->scheduler.setClock(std::move(clock));
+    return true;
+}
+
+bool Dungeon::setCompaction(std::size_t minDead) {
+    if (pimpl_->movement_thread.joinable()) return false;
+    std::lock_guard<std::shared_mutex> guard(pimpl_->npcs_mutex);
+    pimpl_->compact_min_dead = minDead;
+    return true;
+}
+
+std::uint64_t Dungeon::compactedCount() const {
+    std::shared_lock<std::shared_mutex> sguard(pimpl_->npcs_mutex);
+    return pimpl_->compacted;
+}
+
+TickSchedulerStats Dungeon::tickStats() const {
+    return pimpl_->scheduler.stats();
+}
+
+QueueStats Dungeon::fightQueueStats() const noexcept {
+    return pimpl_->fight_queue.stats();
+}
+
 std::mutex & Dungeon::coutMutex() const noexcept {
     return pimpl_->cout_mutex;
 }
\ No newline at end of file
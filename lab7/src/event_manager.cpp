@@ -1,11 +1,176 @@
 #include "observer.hpp"
+#include <algorithm>
+
+namespace {
+
+constexpr std::size_t kDispatchBatch = 64;
+
+}
+
+EventManager::~EventManager() {
+    stopAsync();
+}
 
 void EventManager::subscribe(std::shared_ptr<IObserver> obs) {
-    if (obs) observers_.push_back(std::move(obs));
+    if (!obs) return;
+    std::lock_guard<std::mutex> lock(subscribe_mutex_);
+    const ObserverList* current = observers_.load(std::memory_order_relaxed);
+    auto next = std::make_unique<ObserverList>(current ? *current : ObserverList{});
+    next->push_back(std::move(obs));
+    observers_.store(next.get(), std::memory_order_release);
+    observer_lists_.push_back(std::move(next));
+}
+
+void EventManager::deliver(const DeathEvent &ev) const {
+    const ObserverList* observers = observers_.load(std::memory_order_acquire);
+    if (!observers) return;
+    for (auto &o : *observers) o->onDeath(ev);
 }
 
 void EventManager::notify(const DeathEvent &ev) const {
-    for (auto &o : observers_) {
-        if (o) o->onDeath(ev);
+    if (!async_.load(std::memory_order_acquire)) {
+        deliver(ev);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!async_) {
+        // stopAsync успел вернуть синхронный режим
+        lock.unlock();
+        deliver(ev);
+        return;
+    }
+
+    const std::size_t cap = ring_.size();
+    if (count_ == cap) {
+        switch (policy_) {
+            case OverflowPolicy::Block:
+                not_full_.wait(lock, [&]() { return count_ < cap || !async_; });
+                if (!async_) {
+                    lock.unlock();
+                    deliver(ev);
+                    return;
+                }
+                break;
+            case OverflowPolicy::DropOldest:
+                head_ = (head_ + 1) % cap;
+                --count_;
+                ++dropped_;
+                break;
+            case OverflowPolicy::DropNewest:
+                ++dropped_;
+                return;
+        }
+    }
+
+    Queued &slot = ring_[(head_ + count_) % cap];
+    slot.ev = ev;
+    slot.enqueued = Clock::now();
+    ++count_;
+    high_water_ = std::max(high_water_, count_);
+    lock.unlock();
+    not_empty_.notify_one();
+}
+
+bool EventManager::startAsync(std::size_t capacity, OverflowPolicy policy) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (async_ || capacity == 0 || dispatcher_.joinable()) return false;
+    ring_.assign(capacity, Queued{});
+    head_ = 0;
+    count_ = 0;
+    policy_ = policy;
+    stop_ = false;
+    async_ = true;
+    dispatcher_ = std::thread([this]() { dispatchLoop(); });
+    return true;
+}
+
+void EventManager::stopAsync() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!dispatcher_.joinable()) return;
+        stop_ = true;
+    }
+    not_empty_.notify_one();
+    dispatcher_.join();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    async_ = false;
+    ring_.clear();
+    not_full_.notify_all();
+}
+
+bool EventManager::isAsync() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return async_;
+}
+
+void EventManager::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [&]() { return !async_ || (count_ == 0 && in_flight_ == 0); });
+}
+
+DispatchStats EventManager::dispatchStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    DispatchStats s;
+    s.delivered = delivered_;
+    s.dropped = dropped_;
+    s.highWater = high_water_;
+    s.maxLatencyUs = latency_max_us_;
+    if (delivered_) {
+        s.meanLatencyUs = latency_sum_us_ / static_cast<double>(delivered_);
+        const std::uint64_t target = delivered_ - delivered_ / 100;
+        std::uint64_t seen = 0;
+        for (std::size_t b = 0; b < kLatencyBuckets; ++b) {
+            seen += latency_hist_[b];
+            if (seen >= target) {
+                s.p99LatencyUs = static_cast<double>(std::uint64_t{1} << b);
+                break;
+            }
+        }
+    }
+    return s;
+}
+
+void EventManager::dispatchLoop() {
+    std::vector<Queued> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [&]() { return count_ > 0 || stop_; });
+            if (count_ == 0) {
+                // stop_ и очередь пуста
+                async_ = false;
+                idle_.notify_all();
+                return;
+            }
+            const std::size_t k = std::min(count_, kDispatchBatch);
+            batch.resize(k);
+            for (std::size_t i = 0; i < k; ++i) batch[i] = std::move(ring_[(head_ + i) % ring_.size()]);
+            head_ = (head_ + k) % ring_.size();
+            count_ -= k;
+            in_flight_ = k;
+        }
+        not_full_.notify_all();
+
+        double sum = 0, mx = 0;
+        std::uint64_t hist[kLatencyBuckets] = {};
+        for (const Queued &q : batch) {
+            deliver(q.ev);
+            const double us = std::chrono::duration<double, std::micro>(Clock::now() - q.enqueued).count();
+            sum += us;
+            mx = std::max(mx, us);
+            std::size_t b = 0;
+            while (b + 1 < kLatencyBuckets && static_cast<double>(std::uint64_t{1} << b) < us) ++b;
+            ++hist[b];
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        delivered_ += batch.size();
+        latency_sum_us_ += sum;
+        latency_max_us_ = std::max(latency_max_us_, mx);
+        for (std::size_t b = 0; b < kLatencyBuckets; ++b) latency_hist_[b] += hist[b];
+        in_flight_ = 0;
+        if (count_ == 0) idle_.notify_all();
     }
 }
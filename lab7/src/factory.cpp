@@ -1,34 +1,105 @@
 #include "factory.hpp"
 #include "npc_types.hpp"
-#include <sstream> 
+#include <charconv>
+#include <cmath>
+
+namespace {
+
+bool isSpace(char c) noexcept {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+// следующий токен, разделённый пробельными символами; пустой — если строка кончилась
+std::string_view nextToken(std::string_view &s) noexcept {
+    std::size_t i = 0;
+    while (i < s.size() && isSpace(s[i])) ++i;
+    std::size_t j = i;
+    while (j < s.size() && !isSpace(s[j])) ++j;
+    std::string_view tok = s.substr(i, j - i);
+    s.remove_prefix(j);
+    return tok;
+}
+
+bool parseDouble(std::string_view tok, double &out) noexcept {
+    // from_chars не принимает '+', operator>> принимает
+    if (!tok.empty() && tok.front() == '+') {
+        tok.remove_prefix(1);
+        if (tok.empty() || tok.front() == '-') return false;
+    }
+    const char* end = tok.data() + tok.size();
+    auto [ptr, ec] = std::from_chars(tok.data(), end, out);
+    return ec == std::errc() && ptr == end && std::isfinite(out);
+}
+
+}
 
 std::unique_ptr<NPCBase> NPCFactory::create(
     const std::string& type,
     const std::string& name,
     double x, double y)
 {
-    if (type == "Orc")
-        return std::make_unique<Orc>(name, x, y);
+    NPCType id;
+    if (!parseType(type, id)) return nullptr;
+    return create(id, name, x, y);
+}
 
-    if (type == "Bear")
-        return std::make_unique<Bear>(name, x, y);
+std::unique_ptr<NPCBase> NPCFactory::create(NPCType type, const std::string &name, double x, double y) {
+    switch (type) {
+        case NPCType::Orc: return std::make_unique<Orc>(name, x, y);
+        case NPCType::Bear: return std::make_unique<Bear>(name, x, y);
+        case NPCType::Squirrel: return std::make_unique<Squirrel>(name, x, y);
+        case NPCType::Bandit: return std::make_unique<Bandit>(name, x, y);
+        case NPCType::Werewolf: return std::make_unique<Werewolf>(name, x, y);
+    }
+    return nullptr;
+}
 
-    if (type == "Squirrel")
-        return std::make_unique<Squirrel>(name, x, y);
+std::unique_ptr<NPCBase> NPCFactory::create(const NPCSpec &spec) {
+    return create(spec.type, spec.name, spec.x, spec.y);
+}
 
-    if (type == "Bandit")
-        return std::make_unique<Bandit>(name, x, y);
+std::unique_ptr<NPCBase> NPCFactory::createFromLine(const std::string &line) {
+    NPCSpec spec;
+    if (!parseLine(line, spec)) return nullptr;
+    return create(spec);
+}
 
-    if (type == "Werewolf")
-        return std::make_unique<Werewolf>(name, x, y);
+bool NPCFactory::parseType(std::string_view token, NPCType &out) noexcept {
+    for (std::size_t i = 0; i < kNPCTypeCount; ++i) {
+        if (token == kNPCTypeNames[i]) {
+            out = static_cast<NPCType>(i);
+            return true;
+        }
+    }
+    return false;
+}
 
-    return nullptr;
+bool NPCFactory::parseLine(std::string_view line, NPCSpec &out) {
+    std::string_view type = nextToken(line);
+    std::string_view name = nextToken(line);
+    std::string_view x = nextToken(line);
+    std::string_view y = nextToken(line);
+    if (y.empty()) return false;
+    if (!parseType(type, out.type)) return false;
+    if (!parseDouble(x, out.x) || !parseDouble(y, out.y)) return false;
+    out.name.assign(name);
+    return true;
 }
 
-std::unique_ptr<NPCBase> NPCFactory::createFromLine(const std::string &line) {
-    std::istringstream iss(line);
-    std::string type, name;
-    double x, y;
-    if (!(iss >> type >> name >> x >> y)) return nullptr;
-    return create(type, name, x, y);
-}
\ No newline at end of file
+std::size_t NPCFactory::parseBuffer(std::string_view buffer, std::vector<NPCSpec> &out) {
+    std::size_t bad = 0;
+    NPCSpec spec;
+    while (!buffer.empty()) {
+        std::size_t eol = buffer.find('\n');
+        std::string_view line = buffer.substr(0, eol);
+        buffer.remove_prefix(eol == std::string_view::npos ? buffer.size() : eol + 1);
+
+        if (parseLine(line, spec)) {
+            out.push_back(std::move(spec));
+        } else {
+            std::string_view rest = line;
+            if (!nextToken(rest).empty()) ++bad;
+        }
+    }
+    return bad;
+}
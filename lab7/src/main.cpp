@@ -5,9 +5,9 @@
 #include <thread>
 #include <vector>
 #include <mutex>
-#include <fstream>
 #include <string>
 
+#include "async_file_logger.hpp"
 #include "dungeon.hpp"
 #include "factory.hpp"
 #include "observer.hpp"
@@ -24,28 +24,16 @@ private:
     std::mutex &mtx;
 };
 
-struct FileLogger : public IObserver {
-    explicit FileLogger(const std::string &filename, std::mutex &m) : fn(filename), mtx(m) {}
-    void onDeath(const DeathEvent &ev) override {
-        std::lock_guard<std::mutex> lock(mtx);
-        std::ofstream f(fn, std::ios::app);
-        if(f) {
-            f << ev.killer << " убил " << ev.victim
-              << " в точке (" << ev.x << "," << ev.y << ")\n";
-        }
-    }
-private:
-    std::string fn;
-    std::mutex &mtx;
-};
-
 int main() {
     Dungeon dungeon;
 
     std::mutex &coutMtx = dungeon.coutMutex();
 
     dungeon.events().subscribe(std::make_shared<ConsoleLogger>(coutMtx));
-    dungeon.events().subscribe(std::make_shared<FileLogger>("log.txt", coutMtx));
+    auto fileLog = std::make_shared<AsyncFileLogger>("log.txt");
+    dungeon.events().subscribe(fileLog);
+    // вывод в консоль не тормозит поток боёв
+    dungeon.events().startAsync(4096, OverflowPolicy::Block);
 
     std::random_device rd;
     std::mt19937 rng(rd());
@@ -73,5 +61,14 @@ int main() {
     std::cout << "\n=== Финал игры ===\n";
     dungeon.printAll();
 
+    dungeon.events().waitIdle();
+    fileLog->flush();
+    LoggerStats ls = fileLog->stats();
+    std::cout << "log.txt: записано " << ls.written << ", потеряно " << ls.dropped
+              << ", пик очереди " << ls.queue.highWater << "\n";
+    TickSchedulerStats ts = dungeon.tickStats();
+    std::cout << "тики: " << ts.ticks << ", работа " << ts.meanWorkUs << " мкс в среднем, "
+              << "опозданий " << ts.overruns << ", пропущено " << ts.skipped << "\n";
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "mapped_file.hpp"
+
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LAB7_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+void MappedFile::close() noexcept {
+#ifdef LAB7_HAVE_MMAP
+    if (data_ && !buffer_) munmap(const_cast<unsigned char*>(data_), bytes_);
+#endif
+    buffer_.reset();
+    data_ = nullptr;
+    bytes_ = 0;
+}
+
+bool MappedFile::open(const std::string &fname) {
+    close();
+
+#ifdef LAB7_HAVE_MMAP
+    int fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        ::close(fd);
+        return true;
+    }
+    const std::size_t bytes = static_cast<std::size_t>(st.st_size);
+    void* p = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    madvise(p, bytes, MADV_SEQUENTIAL);
+    data_ = static_cast<const unsigned char*>(p);
+    bytes_ = bytes;
+#else
+    std::ifstream f(fname, std::ios::binary | std::ios::ate);
+    if (!f) return false;
+    const std::streamoff len = f.tellg();
+    if (len <= 0) return len == 0;
+    buffer_ = std::make_unique<unsigned char[]>(static_cast<std::size_t>(len));
+    f.seekg(0);
+    if (!f.read(reinterpret_cast<char*>(buffer_.get()), len)) {
+        close();
+        return false;
+    }
+    data_ = buffer_.get();
+    bytes_ = static_cast<std::size_t>(len);
+#endif
+    return true;
+}
@@ -2,11 +2,11 @@
 #include "combat_visitor.hpp"
 
 Orc::Orc(const std::string& name, double x, double y)
-    : NPCBase(name, x, y) {}
+    : NPCBase(NPCType::Orc, name, x, y) {}
 int Orc::moveDistance() const { return 20; }
 int Orc::killDistance() const { return 10; }
 bool Orc::canKill(const NPCBase& other) const {
-    return dynamic_cast<const Orc*>(&other) || dynamic_cast<const Bear*>(&other) || dynamic_cast<const Bear*>(&other);
+    return canKillType(typeId_, other.typeId());
 }
 std::string Orc::type() const { return "Orc"; }
 void Orc::accept(CombatVisitor &v) { v.visit(*this); }
@@ -14,11 +14,11 @@ void Orc::accept(CombatVisitor &v) { v.visit(*this); }
 
 
 Bear::Bear(const std::string& name, double x, double y)
-    : NPCBase(name, x, y) {}
+    : NPCBase(NPCType::Bear, name, x, y) {}
 int Bear::moveDistance() const { return 5; }
 int Bear::killDistance() const { return 10; }
 bool Bear::canKill(const NPCBase& other) const {
-    return dynamic_cast<const Squirrel*>(&other);
+    return canKillType(typeId_, other.typeId());
 }
 std::string Bear::type() const { return "Bear"; }
 void Bear::accept(CombatVisitor &v) { v.visit(*this); }
@@ -26,11 +26,11 @@ void Bear::accept(CombatVisitor &v) { v.visit(*this); }
 
 
 Squirrel::Squirrel(const std::string& name, double x, double y)
-    : NPCBase(name, x, y) {}
+    : NPCBase(NPCType::Squirrel, name, x, y) {}
 int Squirrel::moveDistance() const { return 5; }
 int Squirrel::killDistance() const { return 5; }
-bool Squirrel::canKill(const NPCBase&) const {
-    return false;
+bool Squirrel::canKill(const NPCBase& other) const {
+    return canKillType(typeId_, other.typeId());
 }
 std::string Squirrel::type() const { return "Squirrel"; }
 void Squirrel::accept(CombatVisitor &v) { v.visit(*this); }
@@ -38,11 +38,11 @@ void Squirrel::accept(CombatVisitor &v) { v.visit(*this); }
 
 
 Bandit::Bandit(const std::string& name, double x, double y)
-    : NPCBase(name, x, y) {}
+    : NPCBase(NPCType::Bandit, name, x, y) {}
 int Bandit::moveDistance() const { return 10; }
 int Bandit::killDistance() const { return 10; }
 bool Bandit::canKill(const NPCBase& other) const {
-    return dynamic_cast<const Werewolf*>(&other) != nullptr;
+    return canKillType(typeId_, other.typeId());
 }
 std::string Bandit::type() const { return "Bandit"; }
 void Bandit::accept(CombatVisitor &v) { v.visit(*this); }
@@ -50,11 +50,11 @@ void Bandit::accept(CombatVisitor &v) { v.visit(*this); }
 
 
 Werewolf::Werewolf(const std::string& name, double x, double y)
-    : NPCBase(name, x, y) {}
+    : NPCBase(NPCType::Werewolf, name, x, y) {}
 int Werewolf::moveDistance() const { return 40; }
 int Werewolf::killDistance() const { return 5; }
 bool Werewolf::canKill(const NPCBase& other) const {
-    return dynamic_cast<const Bandit*>(&other) != nullptr;
+    return canKillType(typeId_, other.typeId());
 }
 std::string Werewolf::type() const { return "Werewolf"; }
 void Werewolf::accept(CombatVisitor &v) { v.visit(*this); }
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "pair_set.hpp"
+#include <algorithm>
+
+namespace {
+
+std::size_t mixPair(std::uint64_t k) noexcept {
+    k ^= k >> 31;
+    k *= 0x9e3779b97f4a7c15ULL;
+    k ^= k >> 29;
+    return static_cast<std::size_t>(k);
+}
+
+}
+
+void PairSet::reset() noexcept {
+    size_ = 0;
+    if (++gen_ == 0) {
+        std::fill(slots_.begin(), slots_.end(), Slot{});
+        gen_ = 1;
+    }
+}
+
+bool PairSet::insert(std::uint32_t a, std::uint32_t b) {
+    if ((size_ + 1) * 2 > slots_.size()) grow();
+    const std::uint64_t key = pack(a, b);
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t h = mixPair(key) & mask;; h = (h + 1) & mask) {
+        Slot &s = slots_[h];
+        if (s.gen != gen_) {
+            s.key = key;
+            s.gen = gen_;
+            ++size_;
+            return true;
+        }
+        if (s.key == key) return false;
+    }
+}
+
+bool PairSet::contains(std::uint32_t a, std::uint32_t b) const noexcept {
+    if (slots_.empty()) return false;
+    const std::uint64_t key = pack(a, b);
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t h = mixPair(key) & mask;; h = (h + 1) & mask) {
+        const Slot &s = slots_[h];
+        if (s.gen != gen_) return false;
+        if (s.key == key) return true;
+    }
+}
+
+void PairSet::grow() {
+    std::vector<Slot> old;
+    old.swap(slots_);
+    slots_.assign(std::max<std::size_t>(64, old.size() * 2), Slot{});
+    const std::uint32_t gen = gen_;
+    gen_ = 1;
+    size_ = 0;
+    for (const Slot &s : old) {
+        if (s.gen == gen) insert(static_cast<std::uint32_t>(s.key >> 32), static_cast<std::uint32_t>(s.key));
+    }
+}
@@ -0,0 +1,99 @@
+#include "spatial_grid.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kCoordLimit = 1 << 30;
+
+std::uint64_t mixKey(std::uint64_t k) noexcept {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    return k;
+}
+
+std::int32_t cellCoord(double v, double cell) noexcept {
+    double c = std::floor(v / cell);
+    return static_cast<std::int32_t>(std::clamp(c, -kCoordLimit, kCoordLimit));
+}
+
+}
+
+std::uint32_t SpatialGrid::findCell(std::uint64_t key) const noexcept {
+    const std::size_t mask = table_.size() - 1;
+    for (std::size_t h = mixKey(key) & mask;; h = (h + 1) & mask) {
+        const Slot &s = table_[h];
+        if (s.cell == kNoCell) return kNoCell;
+        if (s.key == key) return s.cell;
+    }
+}
+
+std::uint32_t SpatialGrid::findOrAddCell(std::uint64_t key) {
+    const std::size_t mask = table_.size() - 1;
+    for (std::size_t h = mixKey(key) & mask;; h = (h + 1) & mask) {
+        Slot &s = table_[h];
+        if (s.cell == kNoCell) {
+            s.key = key;
+            s.cell = static_cast<std::uint32_t>(cellKey_.size());
+            cellKey_.push_back(key);
+            return s.cell;
+        }
+        if (s.key == key) return s.cell;
+    }
+}
+
+void SpatialGrid::neighbourCells(std::uint32_t c, std::uint32_t out[4]) const noexcept {
+    // половина соседей: E, SW, S, SE — каждая пара ячеек ровно один раз
+    const std::int32_t cx = keyX(cellKey_[c]);
+    const std::int32_t cy = keyY(cellKey_[c]);
+    out[0] = findCell(packKey(cx + 1, cy));
+    out[1] = findCell(packKey(cx - 1, cy + 1));
+    out[2] = findCell(packKey(cx, cy + 1));
+    out[3] = findCell(packKey(cx + 1, cy + 1));
+}
+
+void SpatialGrid::rebuild(const double* xs, const double* ys, std::size_t n, double cellSize,
+                          const std::uint8_t* alive, const double* radii) {
+    cell_ = std::max(cellSize, 1e-9);
+
+    // таблица с загрузкой не выше 1/2
+    std::size_t cap = 16;
+    while (cap < 2 * n) cap <<= 1;
+    table_.assign(cap, Slot{0, kNoCell});
+    cellKey_.clear();
+    cellOf_.resize(n);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        if (alive && !alive[i]) {
+            cellOf_[i] = kNoCell;
+            continue;
+        }
+        cellOf_[i] = findOrAddCell(packKey(cellCoord(xs[i], cell_), cellCoord(ys[i], cell_)));
+    }
+
+    const std::size_t cells = cellKey_.size();
+    cellStart_.assign(cells + 1, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (cellOf_[i] != kNoCell) ++cellStart_[cellOf_[i] + 1];
+    }
+    for (std::size_t c = 0; c < cells; ++c) cellStart_[c + 1] += cellStart_[c];
+    items_.resize(cellStart_[cells]);
+
+    // устойчивая раскладка: внутри ячейки индексы идут по возрастанию
+    fill_.assign(cellStart_.begin(), cellStart_.end() - 1);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (cellOf_[i] != kNoCell) items_[fill_[cellOf_[i]]++] = static_cast<std::uint32_t>(i);
+    }
+
+    const std::size_t m = items_.size();
+    sortedX_.resize(m);
+    sortedY_.resize(m);
+    sortedR_.resize(m);
+    for (std::size_t p = 0; p < m; ++p) {
+        const std::uint32_t i = items_[p];
+        sortedX_[p] = xs[i];
+        sortedY_[p] = ys[i];
+        sortedR_[p] = radii ? radii[i] : 0.0;
+    }
+}
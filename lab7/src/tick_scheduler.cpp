@@ -0,0 +1,157 @@
+#include "tick_scheduler.hpp"
+#include <algorithm>
+
+namespace {
+
+double toUs(TickScheduler::Clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+}
+
+TickClock::Clock::time_point SteadyTickClock::now() {
+    return Clock::now();
+}
+
+void SteadyTickClock::waitUntil(std::unique_lock<std::mutex> &lock, std::condition_variable &cv,
+                                Clock::time_point deadline, const std::function<bool()> &stop) {
+    cv.wait_until(lock, deadline, stop);
+}
+
+TickClock::Clock::time_point ManualTickClock::now() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return now_;
+}
+
+void ManualTickClock::waitUntil(std::unique_lock<std::mutex> &lock, std::condition_variable &cv,
+                                Clock::time_point deadline, const std::function<bool()> &stop) {
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (advance_on_wait_) {
+            if (!stop()) now_ = std::max(now_, deadline);
+            return;
+        }
+        waiter_mutex_ = lock.mutex();
+        waiter_cv_ = &cv;
+    }
+    cv.wait(lock, [&]() { return stop() || now() >= deadline; });
+    std::lock_guard<std::mutex> guard(mutex_);
+    waiter_mutex_ = nullptr;
+    waiter_cv_ = nullptr;
+}
+
+void ManualTickClock::advance(Clock::duration d) {
+    std::mutex* m;
+    std::condition_variable* cv;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        now_ += d;
+        m = waiter_mutex_;
+        cv = waiter_cv_;
+    }
+    if (!cv) return;
+    // ожидающий проверяет время под своим мьютексом: пробуждение не потеряется
+    { std::lock_guard<std::mutex> lock(*m); }
+    cv->notify_all();
+}
+
+TickScheduler::TickScheduler(Clock::duration period, OverrunPolicy policy, std::size_t maxCatchUp,
+                             std::shared_ptr<TickClock> clock)
+    : period_(period > Clock::duration::zero() ? period : std::chrono::milliseconds(200)),
+      policy_(policy),
+      max_catch_up_(maxCatchUp),
+      clock_(clock ? std::move(clock) : std::make_shared<SteadyTickClock>()) {}
+
+bool TickScheduler::configure(Clock::duration period, OverrunPolicy policy, std::size_t maxCatchUp) {
+    if (period <= Clock::duration::zero()) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    period_ = period;
+    policy_ = policy;
+    max_catch_up_ = maxCatchUp;
+    return true;
+}
+
+TickScheduler::Clock::duration TickScheduler::period() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return period_;
+}
+
+void TickScheduler::setClock(std::shared_ptr<TickClock> clock) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    clock_ = clock ? std::move(clock) : std::make_shared<SteadyTickClock>();
+}
+
+void TickScheduler::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cancelled_ = false;
+    next_ = clock_->now();
+    stats_ = TickSchedulerStats{};
+    stats_.periodUs = toUs(period_);
+    work_sum_us_ = 0;
+    jitter_sum_us_ = 0;
+}
+
+bool TickScheduler::waitNext() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    clock_->waitUntil(lock, cv_, next_, [this]() { return cancelled_; });
+    if (cancelled_) return false;
+
+    tick_start_ = clock_->now();
+    const double jitter = toUs(std::max(tick_start_ - next_, Clock::duration::zero()));
+    jitter_sum_us_ += jitter;
+    stats_.maxJitterUs = std::max(stats_.maxJitterUs, jitter);
+    return true;
+}
+
+void TickScheduler::endTick() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Clock::time_point now = clock_->now();
+    const Clock::duration work = now - tick_start_;
+
+    ++stats_.ticks;
+    const double work_us = toUs(work);
+    work_sum_us_ += work_us;
+    stats_.maxWorkUs = std::max(stats_.maxWorkUs, work_us);
+    stats_.meanWorkUs = work_sum_us_ / static_cast<double>(stats_.ticks);
+    stats_.meanJitterUs = jitter_sum_us_ / static_cast<double>(stats_.ticks);
+    if (work > period_) ++stats_.overruns;
+
+    const Clock::time_point slot = next_ + period_;
+    if (now < slot) {
+        next_ = slot;
+        return;
+    }
+
+    // прошедшие слоты, начиная с ближайшего: slot, slot + period, ... <= now
+    const std::uint64_t missed = static_cast<std::uint64_t>((now - slot) / period_) + 1;
+    switch (policy_) {
+        case OverrunPolicy::Skip:
+            next_ = slot + period_ * static_cast<Clock::rep>(missed);
+            stats_.skipped += missed;
+            break;
+        case OverrunPolicy::CatchUp: {
+            // долг больше maxCatchUp тиков списывается, остальное — подряд
+            const std::uint64_t dropped = missed > max_catch_up_ ? missed - max_catch_up_ : 0;
+            next_ = slot + period_ * static_cast<Clock::rep>(dropped);
+            stats_.skipped += dropped;
+            if (next_ <= now) ++stats_.caughtUp;
+            break;
+        }
+        case OverrunPolicy::Stretch:
+            next_ = now;
+            break;
+    }
+}
+
+void TickScheduler::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled_ = true;
+    }
+    cv_.notify_all();
+}
+
+TickSchedulerStats TickScheduler::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
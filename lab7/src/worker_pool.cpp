@@ -0,0 +1,82 @@
+#include "worker_pool.hpp"
+#include <algorithm>
+
+namespace {
+
+void partBounds(std::size_t n, std::size_t parts, std::size_t k, std::size_t &begin, std::size_t &end) {
+    begin = n * k / parts;
+    end = n * (k + 1) / parts;
+}
+
+}
+
+WorkerPool::WorkerPool(std::size_t threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t w = 1; w < threads; ++w) {
+        threads_.emplace_back([this, w]() { workerLoop(w); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto &t : threads_) t.join();
+}
+
+void WorkerPool::parallelFor(std::size_t n, std::size_t minChunk, const RangeFn &fn) {
+    if (n == 0) return;
+    minChunk = std::max<std::size_t>(minChunk, 1);
+    const std::size_t parts = std::min(size(), (n + minChunk - 1) / minChunk);
+
+    if (parts <= 1) {
+        fn(0, n, 0);
+        return;
+    }
+
+    std::lock_guard<std::mutex> call(call_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &fn;
+        job_n_ = n;
+        job_parts_ = parts;
+        pending_ = parts - 1;
+        ++generation_;
+    }
+    start_cv_.notify_all();
+
+    std::size_t begin, end;
+    partBounds(n, parts, 0, begin, end);
+    fn(begin, end, 0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this]() { return pending_ == 0; });
+    job_ = nullptr;
+}
+
+void WorkerPool::workerLoop(std::size_t worker) {
+    std::size_t seen = 0;
+    for (;;) {
+        const RangeFn* job;
+        std::size_t n, parts;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+            if (worker >= job_parts_) continue;
+            job = job_;
+            n = job_n_;
+            parts = job_parts_;
+        }
+
+        std::size_t begin, end;
+        partBounds(n, parts, worker, begin, end);
+        (*job)(begin, end, worker);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--pending_ == 0) done_cv_.notify_one();
+    }
+}
@@ -0,0 +1,61 @@
+#include "world_frame.hpp"
+#include "factory.hpp"
+#include <algorithm>
+#include <functional>
+
+std::shared_ptr<const NameTable> NameTable::extend(const std::shared_ptr<const NameTable> &prev,
+                                                   const WorldStore &world) {
+    const std::size_t n = world.size();
+    if (prev && prev->count_ == n) return prev;
+
+    auto table = std::make_shared<NameTable>();
+    std::size_t from = 0;
+    if (prev && prev->count_ < n) {
+        // неполный последний блок prev собирается заново
+        const std::size_t full = prev->count_ / kBlock;
+        table->blocks_.assign(prev->blocks_.begin(), prev->blocks_.begin() + full);
+        from = full * kBlock;
+    }
+    for (std::size_t begin = from; begin < n; begin += kBlock) {
+        const std::size_t end = std::min(n, begin + kBlock);
+        auto block = std::make_shared<std::vector<std::string>>();
+        block->reserve(end - begin);
+        for (std::size_t id = begin; id < end; ++id) block->push_back(world.name(static_cast<NPCId>(id)));
+        table->blocks_.push_back(std::move(block));
+    }
+    table->count_ = n;
+    return table;
+}
+
+NPCId NameTable::find(std::string_view name) const {
+    std::call_once(index_once_, [this]() {
+        std::size_t capacity = 16;
+        while (capacity < count_ * 2) capacity *= 2;
+        index_.assign(capacity, 0);
+        const std::size_t mask = capacity - 1;
+        for (std::size_t id = 0; id < count_; ++id) {
+            const std::string &s = (*this)[static_cast<NPCId>(id)];
+            for (std::size_t h = std::hash<std::string_view>{}(s) & mask;; h = (h + 1) & mask) {
+                NPCId &slot = index_[h];
+                if (slot == 0) {
+                    slot = static_cast<NPCId>(id + 1);
+                    break;
+                }
+                if ((*this)[slot - 1] == s) break;
+            }
+        }
+    });
+
+    const std::size_t mask = index_.size() - 1;
+    for (std::size_t h = std::hash<std::string_view>{}(name) & mask;; h = (h + 1) & mask) {
+        const NPCId slot = index_[h];
+        if (slot == 0) return kNoNPC;
+        if ((*this)[slot - 1] == name) return slot - 1;
+    }
+}
+
+std::unique_ptr<NPCBase> WorldFrame::materialize(NPCId id) const {
+    auto npc = NPCFactory::create(types[id], name(id), xs[id], ys[id]);
+    if (npc && !alive(id)) npc->markDead();
+    return npc;
+}
@@ -0,0 +1,140 @@
+#include "world_journal.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace journal {
+
+namespace {
+
+std::uint32_t fnv1a(const char* p, std::size_t n) noexcept {
+    std::uint32_t h = 2166136261u;
+    for (std::size_t i = 0; i < n; ++i) {
+        h ^= static_cast<unsigned char>(p[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+template <class T>
+void put(std::string &out, T v) {
+    char buf[sizeof(T)];
+    std::memcpy(buf, &v, sizeof(T));
+    out.append(buf, sizeof(T));
+}
+
+// чтение с проверкой границ кадра
+struct Reader {
+    const char* p;
+    const char* end;
+
+    template <class T>
+    bool get(T &v) noexcept {
+        if (static_cast<std::size_t>(end - p) < sizeof(T)) return false;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+};
+
+// все записи кадра или ни одной: сначала проверка, затем применение
+bool applyFrame(const char* data, std::size_t n, WorldStore &world, bool commit) {
+    Reader r{data, data + n};
+    std::size_t size = world.size();
+    while (r.p < r.end) {
+        std::uint8_t tag;
+        if (!r.get(tag)) return false;
+        if (tag == kSpawn) {
+            std::uint8_t type, alive;
+            double x, y;
+            std::uint16_t len;
+            if (!r.get(type) || !r.get(alive) || !r.get(x) || !r.get(y) || !r.get(len)) return false;
+            if (type >= kNPCTypeCount || static_cast<std::size_t>(r.end - r.p) < len) return false;
+            if (commit) {
+                NPCId id = world.add(static_cast<NPCType>(type), std::string(r.p, len), x, y);
+                if (!alive) world.markDead(id);
+            }
+            r.p += len;
+            ++size;
+        } else if (tag == kDeath) {
+            NPCId id;
+            if (!r.get(id) || id >= size) return false;
+            if (commit) world.markDead(id);
+        } else if (tag == kMove) {
+            NPCId id;
+            float dx, dy;
+            if (!r.get(id) || !r.get(dx) || !r.get(dy) || id >= size) return false;
+            if (commit) world.setPosition(id, world.x(id) + dx, world.y(id) + dy);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+void Frame::spawn(NPCType type, std::string_view name, double x, double y, bool alive) {
+    const std::uint16_t len = static_cast<std::uint16_t>(std::min<std::size_t>(name.size(), 0xFFFF));
+    put(bytes_, static_cast<std::uint8_t>(kSpawn));
+    put(bytes_, static_cast<std::uint8_t>(type));
+    put(bytes_, static_cast<std::uint8_t>(alive ? 1 : 0));
+    put(bytes_, x);
+    put(bytes_, y);
+    put(bytes_, len);
+    bytes_.append(name.data(), len);
+}
+
+void Frame::death(NPCId id) {
+    put(bytes_, static_cast<std::uint8_t>(kDeath));
+    put(bytes_, id);
+}
+
+void Frame::move(NPCId id, float dx, float dy) {
+    put(bytes_, static_cast<std::uint8_t>(kMove));
+    put(bytes_, id);
+    put(bytes_, dx);
+    put(bytes_, dy);
+}
+
+bool Frame::appendTo(const std::string &fname) const {
+    FrameHeader h{kFrameMagic, static_cast<std::uint32_t>(bytes_.size()), fnv1a(bytes_.data(), bytes_.size())};
+    std::ofstream f(fname, std::ios::binary | std::ios::app);
+    if (!f) return false;
+    f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    f.write(bytes_.data(), static_cast<std::streamsize>(bytes_.size()));
+    f.flush();
+    return static_cast<bool>(f);
+}
+
+bool truncate(const std::string &fname) {
+    std::ofstream f(fname, std::ios::binary | std::ios::trunc);
+    return static_cast<bool>(f);
+}
+
+std::size_t replay(const std::string &fname, WorldStore &world) {
+    std::ifstream f(fname, std::ios::binary | std::ios::ate);
+    if (!f) return 0;
+    std::string data(static_cast<std::size_t>(f.tellg()), '\0');
+    f.seekg(0);
+    if (!f.read(data.data(), static_cast<std::streamsize>(data.size()))) return 0;
+
+    std::size_t frames = 0;
+    std::size_t pos = 0;
+    while (data.size() - pos >= sizeof(FrameHeader)) {
+        FrameHeader h;
+        std::memcpy(&h, data.data() + pos, sizeof(h));
+        pos += sizeof(h);
+        if (h.magic != kFrameMagic || data.size() - pos < h.bytes) break;
+        const char* body = data.data() + pos;
+        if (fnv1a(body, h.bytes) != h.checksum) break;
+        if (!applyFrame(body, h.bytes, world, false)) break;
+        applyFrame(body, h.bytes, world, true);
+        pos += h.bytes;
+        ++frames;
+    }
+    return frames;
+}
+
+}
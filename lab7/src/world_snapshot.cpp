@@ -0,0 +1,132 @@
+#include "world_snapshot.hpp"
+#include "world_frame.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+namespace snapshot {
+
+bool isSnapshot(const std::string &fname) {
+    std::ifstream f(fname, std::ios::binary);
+    char magic[sizeof(kMagic)];
+    if (!f.read(magic, sizeof(magic))) return false;
+    return std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+namespace {
+
+// WorldStore и WorldFrame дают одинаковые методы доступа по NPCId
+template <class World>
+bool writeWorld(const std::string &fname, const World &world) {
+    const std::size_t n = world.size();
+    std::vector<Record> records(n);
+    std::string names;
+    for (NPCId id = 0; id < n; ++id) {
+        const std::string &name = world.name(id);
+        if (name.size() > std::numeric_limits<std::uint16_t>::max()) return false;
+        if (names.size() + name.size() > std::numeric_limits<std::uint32_t>::max()) return false;
+        Record &r = records[id];
+        r.x = world.x(id);
+        r.y = world.y(id);
+        r.nameOffset = static_cast<std::uint32_t>(names.size());
+        r.nameLength = static_cast<std::uint16_t>(name.size());
+        r.type = static_cast<std::uint8_t>(world.type(id));
+        r.alive = world.alive(id) ? 1 : 0;
+        names += name;
+    }
+
+    Header h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.recordSize = sizeof(Record);
+    h.count = n;
+    h.namesBytes = names.size();
+
+    std::ofstream f(fname, std::ios::binary | std::ios::trunc);
+    if (!f) return false;
+    f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    f.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(n * sizeof(Record)));
+    f.write(names.data(), static_cast<std::streamsize>(names.size()));
+    return static_cast<bool>(f);
+}
+
+}
+
+bool write(const std::string &fname, const WorldStore &world) {
+    return writeWorld(fname, world);
+}
+
+bool write(const std::string &fname, const WorldFrame &frame) {
+    return writeWorld(fname, frame);
+}
+
+bool read(const std::string &fname, WorldStore &out) {
+    MappedSnapshot snap;
+    if (!snap.open(fname)) return false;
+    out.clear();
+    out.reserve(snap.size());
+    for (std::size_t i = 0; i < snap.size(); ++i) {
+        const auto e = snap.entry(i);
+        NPCId id = out.add(e.type, std::string(e.name), e.x, e.y);
+        if (!e.alive) out.markDead(id);
+    }
+    return true;
+}
+
+MappedSnapshot::~MappedSnapshot() {
+    close();
+}
+
+void MappedSnapshot::close() noexcept {
+    file_.close();
+    count_ = 0;
+    records_ = nullptr;
+    names_ = nullptr;
+}
+
+bool MappedSnapshot::open(const std::string &fname) {
+    close();
+    if (!file_.open(fname)) return false;
+    if (file_.size() < sizeof(Header)) {
+        close();
+        return false;
+    }
+    const unsigned char* data = file_.data();
+
+    Header h;
+    std::memcpy(&h, data, sizeof(h));
+    const std::size_t body = file_.size() - sizeof(Header);
+    const bool headerOk = std::memcmp(h.magic, kMagic, sizeof(kMagic)) == 0 && h.version == kVersion &&
+                          h.recordSize == sizeof(Record) && h.namesBytes <= body &&
+                          h.count == (body - h.namesBytes) / sizeof(Record) &&
+                          h.count * sizeof(Record) + h.namesBytes == body;
+    if (!headerOk) {
+        close();
+        return false;
+    }
+
+    count_ = static_cast<std::size_t>(h.count);
+    records_ = reinterpret_cast<const Record*>(data + sizeof(Header));
+    names_ = reinterpret_cast<const char*>(data + sizeof(Header) + count_ * sizeof(Record));
+
+    // один проход проверки, чтобы entry() мог доверять записям
+    for (std::size_t i = 0; i < count_; ++i) {
+        const Record &r = records_[i];
+        if (r.type >= kNPCTypeCount || r.alive > 1 ||
+            static_cast<std::uint64_t>(r.nameOffset) + r.nameLength > h.namesBytes) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+MappedSnapshot::Entry MappedSnapshot::entry(std::size_t i) const noexcept {
+    const Record &r = records_[i];
+    return {static_cast<NPCType>(r.type), std::string_view(names_ + r.nameOffset, r.nameLength), r.x, r.y,
+            r.alive != 0};
+}
+
+}
@@ -0,0 +1,198 @@
+#include "world_store.hpp"
+#include "factory.hpp"
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+// дистанции берутся у фасада NPCBase один раз на тип
+struct TypeStats {
+    double move;
+    double kill;
+};
+
+const TypeStats& statsOf(NPCType t) {
+    static const auto table = [] {
+        std::vector<TypeStats> v;
+        for (std::size_t i = 0; i < kNPCTypeCount; ++i) {
+            auto npc = NPCFactory::create(static_cast<NPCType>(i), "", 0.0, 0.0);
+            v.push_back({static_cast<double>(npc->moveDistance()), static_cast<double>(npc->killDistance())});
+        }
+        return v;
+    }();
+    return table[static_cast<std::size_t>(t)];
+}
+
+std::size_t hashName(std::string_view name) noexcept {
+    return std::hash<std::string_view>{}(name);
+}
+
+}
+
+NPCId WorldStore::add(const NPCBase &npc) {
+    NPCId id = add(npc.typeId(), npc.name(), npc.x(), npc.y());
+    if (!npc.alive()) alive_[id] = 0;
+    return id;
+}
+
+NPCId WorldStore::add(NPCType type, std::string name, double x, double y) {
+    const TypeStats &st = statsOf(type);
+    NPCId id = static_cast<NPCId>(x_.size());
+    x_.push_back(x);
+    y_.push_back(y);
+    type_.push_back(type);
+    alive_.push_back(1);
+    move_.push_back(st.move);
+    kill_.push_back(st.kill);
+    name_.push_back(std::move(name));
+
+    std::uint32_t slot;
+    if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        slot = static_cast<std::uint32_t>(slot_id_.size());
+        slot_id_.push_back(kNoNPC);
+        slot_gen_.push_back(0);
+    }
+    slot_id_[slot] = id;
+    handle_.push_back(static_cast<NPCHandle>(slot_gen_[slot]) << 32 | slot);
+
+    indexInsert(id);
+    return id;
+}
+
+NPCId WorldStore::resolve(NPCHandle h) const noexcept {
+    const std::uint64_t slot = h & 0xFFFFFFFFu;
+    if (slot >= slot_id_.size() || slot_gen_[slot] != static_cast<std::uint32_t>(h >> 32)) return kNoNPC;
+    return slot_id_[slot];
+}
+
+std::size_t WorldStore::compact() {
+    const std::size_t n = size();
+    NPCId out = 0;
+    for (NPCId id = 0; id < n; ++id) {
+        const std::uint32_t slot = static_cast<std::uint32_t>(handle_[id]);
+        if (!alive_[id]) {
+            slot_id_[slot] = kNoNPC;
+            ++slot_gen_[slot];
+            free_slots_.push_back(slot);
+            continue;
+        }
+        if (out != id) {
+            x_[out] = x_[id];
+            y_[out] = y_[id];
+            type_[out] = type_[id];
+            alive_[out] = 1;
+            move_[out] = move_[id];
+            kill_[out] = kill_[id];
+            name_[out] = std::move(name_[id]);
+            handle_[out] = handle_[id];
+        }
+        slot_id_[slot] = out;
+        ++out;
+    }
+    const std::size_t removed = n - out;
+    if (removed == 0) return 0;
+
+    x_.resize(out);
+    y_.resize(out);
+    type_.resize(out);
+    alive_.resize(out);
+    move_.resize(out);
+    kill_.resize(out);
+    name_.resize(out);
+    handle_.resize(out);
+    // память мёртвых возвращается, когда колонки заняты меньше чем наполовину
+    if (x_.capacity() > 2 * out) {
+        x_.shrink_to_fit();
+        y_.shrink_to_fit();
+        type_.shrink_to_fit();
+        alive_.shrink_to_fit();
+        move_.shrink_to_fit();
+        kill_.shrink_to_fit();
+        name_.shrink_to_fit();
+        handle_.shrink_to_fit();
+    }
+    // свободные слоты по возрастанию: первым переиспользуется младший
+    std::sort(free_slots_.begin(), free_slots_.end(), std::greater<>());
+    rehash(16);
+    return removed;
+}
+
+NPCId WorldStore::find(std::string_view name) const noexcept {
+    if (index_.empty()) return kNoNPC;
+    const std::size_t mask = index_.size() - 1;
+    for (std::size_t h = hashName(name) & mask;; h = (h + 1) & mask) {
+        const NPCId slot = index_[h];
+        if (slot == 0) return kNoNPC;
+        if (name_[slot - 1] == name) return slot - 1;
+    }
+}
+
+void WorldStore::indexInsert(NPCId id) {
+    if ((name_.size()) * 2 > index_.size()) {
+        rehash(std::max<std::size_t>(16, index_.size() * 2));
+        return;  // rehash уже вставил все имена, включая id
+    }
+    const std::size_t mask = index_.size() - 1;
+    for (std::size_t h = hashName(name_[id]) & mask;; h = (h + 1) & mask) {
+        NPCId &slot = index_[h];
+        if (slot == 0) {
+            slot = id + 1;
+            return;
+        }
+        if (name_[slot - 1] == name_[id]) return;
+    }
+}
+
+void WorldStore::rehash(std::size_t capacity) {
+    while (capacity < name_.size() * 2) capacity *= 2;
+    index_.assign(capacity, 0);
+    const std::size_t mask = capacity - 1;
+    for (NPCId id = 0; id < name_.size(); ++id) {
+        for (std::size_t h = hashName(name_[id]) & mask;; h = (h + 1) & mask) {
+            NPCId &slot = index_[h];
+            if (slot == 0) {
+                slot = id + 1;
+                break;
+            }
+            if (name_[slot - 1] == name_[id]) break;
+        }
+    }
+}
+
+std::unique_ptr<NPCBase> WorldStore::materialize(NPCId id) const {
+    auto npc = NPCFactory::create(type_[id], name_[id], x_[id], y_[id]);
+    if (npc && !alive_[id]) npc->markDead();
+    return npc;
+}
+
+void WorldStore::reserve(std::size_t n) {
+    x_.reserve(n);
+    y_.reserve(n);
+    type_.reserve(n);
+    alive_.reserve(n);
+    move_.reserve(n);
+    kill_.reserve(n);
+    name_.reserve(n);
+    handle_.reserve(n);
+    std::size_t cap = 16;
+    while (cap < n * 2) cap <<= 1;
+    if (cap > index_.size()) rehash(cap);
+}
+
+void WorldStore::clear() noexcept {
+    x_.clear();
+    y_.clear();
+    type_.clear();
+    alive_.clear();
+    move_.clear();
+    kill_.clear();
+    name_.clear();
+    handle_.clear();
+    slot_id_.clear();
+    slot_gen_.clear();
+    free_slots_.clear();
+    index_.clear();
+}
@@ -1,9 +1,31 @@
 #include <gtest/gtest.h>
 #include "factory.hpp" // Проверка создания NPC
 #include "npc.hpp"     // Проверка базового класса
+#include "spatial_grid.hpp"
+#include "distance_kernel.hpp"
+#include "dungeon.hpp"
+#include "world_store.hpp"
+#include "world_frame.hpp"
+#include "worker_pool.hpp"
+#include "mpsc_ring.hpp"
+#include "observer.hpp"
+#include "pair_set.hpp"
+#include "async_file_logger.hpp"
+#include "tick_scheduler.hpp"
 #include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 // --- I. Тестирование Фабрики (NPCFactory) ---
 
@@ -43,6 +65,35 @@ TEST(FactoryTests, CreateFromLine) {
     ASSERT_EQ(unknown_line, nullptr);
 }
 
+TEST(FactoryTests, ParseLineEdgeCases) {
+    NPCSpec spec;
+    ASSERT_TRUE(NPCFactory::parseLine("  Werewolf\tW1  +1e1 -0.5 extra\r", spec));
+    ASSERT_EQ(spec.type, NPCType::Werewolf);
+    ASSERT_EQ(spec.name, "W1");
+    ASSERT_DOUBLE_EQ(spec.x, 10.0);
+    ASSERT_DOUBLE_EQ(spec.y, -0.5);
+
+    ASSERT_FALSE(NPCFactory::parseLine("Orc O1 1.5x 2", spec));
+    ASSERT_FALSE(NPCFactory::parseLine("Orc O1 +-1 2", spec));
+    ASSERT_FALSE(NPCFactory::parseLine("Orc O1 inf 2", spec));
+    ASSERT_FALSE(NPCFactory::parseLine("Orc O1 1 nan", spec));
+    ASSERT_FALSE(NPCFactory::parseLine("orc O1 1 2", spec));
+    ASSERT_FALSE(NPCFactory::parseLine("", spec));
+}
+
+TEST(FactoryTests, ParseBuffer) {
+    std::vector<NPCSpec> specs;
+    const std::string text = "Orc O1 1 2\n\nElf E1 1 1\r\nBear B1 3 4\r\n   \nSquirrel S1 5 6";
+    ASSERT_EQ(NPCFactory::parseBuffer(text, specs), 1u);
+    ASSERT_EQ(specs.size(), 3u);
+    ASSERT_EQ(specs[1].name, "B1");
+    ASSERT_EQ(specs[2].type, NPCType::Squirrel);
+    ASSERT_DOUBLE_EQ(specs[2].y, 6.0);
+
+    auto npc = NPCFactory::create(specs[0]);
+    ASSERT_EQ(npc->type(), "Orc");
+}
+
 // --- II. Тестирование Базового Функционала NPC ---
 
 TEST(NPCTests, PositionAndStatus) {
@@ -121,4 +172,1185 @@ TEST(CombatLogicTests, KillMatrixRules) {
     // Orc убивает Bear, но Bear НЕ убивает Orc
     ASSERT_TRUE(checkKillByType_Test("Orc", "Bear"));
     ASSERT_FALSE(checkKillByType_Test("Bear", "Orc"));
-}
\ No newline at end of file
+}
+
+TEST(CombatLogicTests, ConstexprMatrixMatchesRules) {
+    const NPCType ids[] = {NPCType::Orc, NPCType::Bear, NPCType::Squirrel, NPCType::Bandit, NPCType::Werewolf};
+    const char* names[] = {"Orc", "Bear", "Squirrel", "Bandit", "Werewolf"};
+    static_assert(canKillType(NPCType::Orc, NPCType::Bandit));
+    static_assert(!canKillType(NPCType::Squirrel, NPCType::Bear));
+
+    for (int a = 0; a < 5; ++a) {
+        auto npc = NPCFactory::create(names[a], "N", 0, 0);
+        ASSERT_EQ(npc->typeId(), ids[a]);
+        for (int b = 0; b < 5; ++b) {
+            ASSERT_EQ(canKillType(ids[a], ids[b]), checkKillByType_Test(names[a], names[b]));
+            auto other = NPCFactory::create(names[b], "M", 0, 0);
+            ASSERT_EQ(npc->canKill(*other), checkKillByType_Test(names[a], names[b]));
+        }
+    }
+}
+
+// --- III. Тестирование пространственной сетки (SpatialGrid) ---
+
+TEST(SpatialGridTests, MatchesBruteForce) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> pos(0.0, 100.0);
+    std::vector<double> xs, ys;
+    for (int i = 0; i < 400; ++i) {
+        xs.push_back(pos(rng));
+        ys.push_back(pos(rng));
+    }
+    const double r = 10.0;
+
+    std::set<std::pair<std::uint32_t, std::uint32_t>> expected;
+    for (std::uint32_t i = 0; i < xs.size(); ++i)
+        for (std::uint32_t j = i + 1; j < xs.size(); ++j) {
+            double dx = xs[i] - xs[j], dy = ys[i] - ys[j];
+            if (dx*dx + dy*dy <= r*r) expected.insert({i, j});
+        }
+
+    SpatialGrid grid;
+    grid.rebuild(xs.data(), ys.data(), xs.size(), r);
+
+    // 1. Каждая пара выдаётся не больше одного раза и с i < j
+    std::set<std::pair<std::uint32_t, std::uint32_t>> found;
+    grid.forEachCandidatePair([&](std::uint32_t i, std::uint32_t j) {
+        ASSERT_LT(i, j);
+        ASSERT_TRUE(found.insert({i, j}).second);
+    });
+
+    // 2. Все близкие пары среди кандидатов
+    for (const auto &p : expected) ASSERT_EQ(found.count(p), 1u);
+    ASSERT_LT(found.size(), xs.size() * (xs.size() - 1) / 2);
+}
+
+TEST(SpatialGridTests, SparseLargeWorld) {
+    // Мир 100000 x 100000: хранятся только занятые ячейки
+    std::vector<double> xs = {5.0, 9.0, 99990.0, 50000.0};
+    std::vector<double> ys = {5.0, 12.0, 99990.0, 50000.0};
+
+    SpatialGrid grid;
+    grid.rebuild(xs.data(), ys.data(), xs.size(), 10.0);
+    ASSERT_LE(grid.cellCount(), xs.size());
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+    grid.forEachCandidatePair([&](std::uint32_t i, std::uint32_t j) { pairs.push_back({i, j}); });
+    ASSERT_EQ(pairs.size(), 1u);
+    ASSERT_EQ(pairs[0], std::make_pair(0u, 1u));
+}
+
+TEST(SpatialGridTests, PairsInRangeMatchBruteForce) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> pos(0.0, 100.0);
+    std::uniform_int_distribution<int> kind(0, 1);
+    std::vector<double> xs, ys, rs;
+    for (int i = 0; i < 500; ++i) {
+        xs.push_back(pos(rng));
+        ys.push_back(pos(rng));
+        rs.push_back(kind(rng) ? 10.0 : 5.0);
+    }
+
+    std::set<std::pair<std::uint32_t, std::uint32_t>> expected;
+    for (std::uint32_t i = 0; i < xs.size(); ++i)
+        for (std::uint32_t j = i + 1; j < xs.size(); ++j) {
+            double dx = xs[i] - xs[j], dy = ys[i] - ys[j];
+            double r = std::max(rs[i], rs[j]);
+            if (dx*dx + dy*dy <= r*r) expected.insert({i, j});
+        }
+
+    SpatialGrid grid;
+    grid.rebuild(xs.data(), ys.data(), xs.size(), 10.0, nullptr, rs.data());
+    std::set<std::pair<std::uint32_t, std::uint32_t>> found;
+    grid.forEachPairInRange([&](std::uint32_t i, std::uint32_t j) {
+        ASSERT_LT(i, j);
+        ASSERT_TRUE(found.insert({i, j}).second);
+    });
+    ASSERT_EQ(found, expected);
+}
+
+// --- IIIa. Векторное ядро проверки дальности ---
+
+TEST(DistanceKernelTests, AllLevelsMatchScalar) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> pos(0.0, 30.0);
+    std::vector<double> xs(kRangeBlock), ys(kRangeBlock), rs(kRangeBlock);
+    for (std::size_t k = 0; k < kRangeBlock; ++k) {
+        xs[k] = pos(rng);
+        ys[k] = pos(rng);
+        rs[k] = (k % 3) ? 5.0 : 10.0;
+    }
+    // точно на границе: 3-4-5
+    xs[5] = 13.0; ys[5] = 14.0; rs[5] = 5.0;
+
+    RangeMaskFn scalar = rangeMaskKernel(SimdLevel::Scalar);
+    ASSERT_NE(scalar, nullptr);
+    ASSERT_TRUE(scalar(10.0, 10.0, 5.0, xs.data(), ys.data(), rs.data(), kRangeBlock) & (1ull << 5));
+
+    for (SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2}) {
+        RangeMaskFn fn = rangeMaskKernel(level);
+        if (!fn) continue;  // не поддерживается процессором
+        for (std::size_t n : {std::size_t{1}, std::size_t{3}, std::size_t{7}, kRangeBlock}) {
+            ASSERT_EQ(fn(10.0, 10.0, 5.0, xs.data(), ys.data(), rs.data(), n),
+                      scalar(10.0, 10.0, 5.0, xs.data(), ys.data(), rs.data(), n))
+                << simdLevelName(level) << " n=" << n;
+        }
+    }
+}
+
+// --- IV. Тестирование подземелья (Dungeon) ---
+
+TEST(DungeonTests, WorldSizeBoundsValidation) {
+    Dungeon d;
+    ASSERT_TRUE(d.addNPC(NPCFactory::create("Orc", "O1", 50.0, 50.0)));
+    ASSERT_FALSE(d.addNPC(NPCFactory::create("Orc", "O2", 5000.0, 50.0)));
+    ASSERT_FALSE(d.addNPC(NPCFactory::create("Orc", "O1", 10.0, 10.0)));  // дубликат имени
+
+    ASSERT_FALSE(d.setWorldSize(0.0, 10.0));
+    ASSERT_TRUE(d.setWorldSize(100000.0, 100000.0));
+    ASSERT_DOUBLE_EQ(d.worldWidth(), 100000.0);
+    ASSERT_TRUE(d.addNPC(NPCFactory::create("Orc", "O2", 5000.0, 50.0)));
+}
+
+TEST(DungeonTests, RenderFullAndAnsiDiff) {
+    Dungeon d;
+    ASSERT_TRUE(d.addNPC(NPCFactory::create("Orc", "O1", 5.0, 5.0)));
+    ASSERT_TRUE(d.addNPC(NPCFactory::create("Bear", "B1", 99.0, 15.0)));
+    ASSERT_TRUE(d.setRenderGrid(4, 2));
+    ASSERT_FALSE(d.setRenderGrid(0, 2));
+    ASSERT_EQ(d.renderAll(), "--- NPCs (2) ---\n[O][ ][ ][B]\n[ ][ ][ ][ ]\n");
+
+    d.setRenderMode(RenderMode::AnsiDiff);
+    const std::string first = d.renderAll();
+    ASSERT_EQ(first.rfind("\x1b[2J\x1b[H", 0), 0u);
+    ASSERT_NE(first.find("[O][ ][ ][B]\n"), std::string::npos);
+
+    // без изменений — только заголовок и курсор под картой
+    ASSERT_EQ(d.renderAll(), "\x1b[1;1H--- NPCs (2) ---\x1b[K\x1b[4;1H");
+
+    // новый NPC в клетке (1, 1) и вторая фигура в клетке (0, 0): строка 3, столбец 5 и строка 2, столбец 2
+    ASSERT_TRUE(d.addNPC(NPCFactory::create("Squirrel", "S1", 30.0, 60.0)));
+    ASSERT_TRUE(d.addNPC(NPCFactory::create("Bear", "B2", 6.0, 6.0)));
+    ASSERT_EQ(d.renderAll(), "\x1b[1;1H--- NPCs (4) ---\x1b[K\x1b[2;2H*\x1b[3;5HS\x1b[4;1H");
+}
+
+TEST(DungeonTests, HeatmapMergesWorkerHistograms) {
+    Dungeon d;
+    d.setWorkerCount(4);
+    for (int i = 0; i < 10; ++i) d.addNPC(NPCFactory::create("Orc", "O" + std::to_string(i), 10.0, 10.0));
+    for (int i = 0; i < 3; ++i) d.addNPC(NPCFactory::create("Bear", "b" + std::to_string(i), 20.0, 90.0));
+    // десятки тысяч NPC — гистограмма строится несколькими исполнителями
+    for (int i = 0; i < 20000; ++i) d.addNPC(NPCFactory::create("Bear", "B" + std::to_string(i), 75.0, i % 100));
+    d.addNPC(NPCFactory::create("Squirrel", "S", 99.0, 1.0));
+    auto dead = NPCFactory::create("Squirrel", "dead", 20.0, 20.0);
+    dead->markDead();
+    d.addNPC(std::move(dead));
+
+    ASSERT_TRUE(d.setRenderGrid(3, 1));
+    d.setRenderMode(RenderMode::DominantType);
+    ASSERT_EQ(d.renderAll(), "--- NPCs (20014) ---\nO B\n");
+    d.setRenderMode(RenderMode::Density);
+    ASSERT_EQ(d.renderAll(), "--- NPCs (20014) ---\n. @\n");
+}
+
+TEST(DungeonTests, FindByNameAfterAddLoadClear) {
+    Dungeon d;
+    ASSERT_TRUE(d.addNPC(NPCFactory::create("Bandit", "Bn1", 12.0, 13.0)));
+    auto found = d.findNPC("Bn1");
+    ASSERT_NE(found, nullptr);
+    ASSERT_EQ(found->type(), "Bandit");
+    ASSERT_NEAR(found->y(), 13.0, 0.001);
+    ASSERT_EQ(d.findNPC("nobody"), nullptr);
+
+    d.clear();
+    ASSERT_EQ(d.findNPC("Bn1"), nullptr);
+    ASSERT_TRUE(d.addNPC(NPCFactory::create("Orc", "Bn1", 1.0, 1.0)));
+    ASSERT_EQ(d.findNPC("Bn1")->type(), "Orc");
+}
+
+TEST(DungeonTests, PublishedFramesAreImmutable) {
+    Dungeon d;
+    ASSERT_TRUE(d.setSeed(5));
+    ASSERT_TRUE(d.setCompaction(0));   // блоки имён делятся, пока NPCId не менялись
+    for (int i = 0; i < 5000; ++i) {
+        ASSERT_TRUE(d.addNPC(NPCFactory::create(i % 2 ? "Squirrel" : "Bear", "F" + std::to_string(i),
+                                                i % 100 * 1.0, i / 50 * 1.0)));
+    }
+    auto first = d.frame();
+    ASSERT_EQ(first->size(), 5000u);
+    ASSERT_EQ(first->tick, 0u);
+    ASSERT_EQ(first->find("F4097"), 4097u);
+    ASSERT_EQ(d.frame(), first);   // мир не менялся — тот же кадр
+
+    const std::vector<double> xs = first->xs;
+    d.runTicks(3);
+    auto later = d.frame();
+    ASSERT_EQ(later->tick, 3u);
+    ASSERT_EQ(first->xs, xs);
+    ASSERT_NE(later->xs, xs);
+    ASSERT_EQ(later->aliveCount, d.aliveCount());
+    // полные блоки имён общие с прошлым кадром
+    ASSERT_EQ(&later->name(10), &first->name(10));
+
+    ASSERT_TRUE(d.addNPC(NPCFactory::create("Orc", "late", 5.0, 5.0)));
+    ASSERT_EQ(d.frame()->find("late"), 5000u);
+    ASSERT_EQ(first->find("late"), kNoNPC);
+}
+
+TEST(DungeonTests, ReadersUseFramesDuringSimulation) {
+    Dungeon d;
+    ASSERT_TRUE(d.setCompaction(0));   // все имена остаются в мире
+    for (int i = 0; i < 2000; ++i) {
+        ASSERT_TRUE(d.addNPC(NPCFactory::create(i % 2 ? "Orc" : "Bandit", "R" + std::to_string(i),
+                                                i % 100 * 1.0, i / 20 * 1.0)));
+    }
+    ASSERT_TRUE(d.setTickRate(1000.0));
+    d.startSimulation(0);
+    // читаем, пока поток перемещений не опубликует несколько тиков; срок — только страховка
+    constexpr std::uint64_t kTicks = 5;
+    std::uint64_t last_tick = 0;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (last_tick < kTicks && std::chrono::steady_clock::now() < deadline) {
+        auto f = d.frame();
+        ASSERT_GE(f->tick, last_tick);
+        last_tick = f->tick;
+        ASSERT_EQ(f->size(), 2000u);
+        ASSERT_NE(d.findNPC("R7"), nullptr);
+        ASSERT_FALSE(d.renderAll().empty());
+    }
+    d.stopSimulation();
+    d.joinSimulation();
+    ASSERT_GE(last_tick, kTicks);
+
+    // после остановки кадр догоняет последние бои
+    std::size_t alive = 0;
+    for (int i = 0; i < 2000; ++i) alive += d.findNPC("R" + std::to_string(i))->alive();
+    ASSERT_EQ(d.aliveCount(), alive);
+}
+
+TEST(DungeonTests, AddedNPCVisibleDuringSimulation) {
+    Dungeon d;
+    ASSERT_TRUE(d.setCompaction(0));
+    ASSERT_TRUE(d.addNPC(NPCFactory::create("Orc", "First", 10.0, 10.0)));
+    d.startSimulation(0);
+    ASSERT_TRUE(d.addNPC(NPCFactory::create("Bear", "Late", 90.0, 90.0)));
+    // кадр не ждёт следующего тика
+    ASSERT_NE(d.findNPC("Late"), nullptr);
+    ASSERT_EQ(d.frame()->size(), 2u);
+    d.stopSimulation();
+    d.joinSimulation();
+}
+
+TEST(DungeonTests, SaveLoadRoundTrip) {
+    const std::string fname = "dungeon_roundtrip_test.txt";
+    {
+        Dungeon d;
+        ASSERT_TRUE(d.addNPC(NPCFactory::create("Bear", "B1", 10.0, 20.0)));
+        ASSERT_TRUE(d.addNPC(NPCFactory::create("Werewolf", "W1", 30.5, 40.5)));
+        ASSERT_TRUE(d.saveToFile(fname));
+    }
+    {
+        std::ofstream f(fname, std::ios::app);
+        f << "Orc B1 1 1\n";       // дубликат имени — пропускается
+        f << "Orc O1 1000 1\n";    // вне мира — пропускается
+    }
+
+    Dungeon d;
+    ASSERT_TRUE(d.loadFromFile(fname));
+    const std::string copy = "dungeon_roundtrip_copy.txt";
+    ASSERT_TRUE(d.saveToFile(copy));
+
+    std::ifstream f(copy);
+    std::string a, b;
+    std::getline(f, a);
+    std::getline(f, b);
+    ASSERT_EQ(a, "Bear B1 10 20");
+    ASSERT_EQ(b, "Werewolf W1 30.5 40.5");
+    ASSERT_FALSE(std::getline(f, a));
+
+    std::remove(fname.c_str());
+    std::remove(copy.c_str());
+}
+
+TEST(DungeonTests, ParallelTextLoadKeepsFirstOccurrence) {
+    // несколько мегабайт — файл делится на куски между исполнителями
+    const std::string fname = "dungeon_chunked_test.txt";
+    const int n = 150000;
+    {
+        std::ofstream f(fname);
+        for (int i = 0; i < n; ++i) f << "Orc npc_" << i << " " << i % 100 << " " << i % 50 << "\n";
+        for (int i = 0; i < n; i += 1000) f << "Bear npc_" << i << " 1 1\n";     // повторы — пропускаются
+        f << "Bear late 1 1\nBear far 1 500\nbroken line\n";
+    }
+
+    Dungeon d;
+    d.setWorkerCount(4);
+    ASSERT_TRUE(d.loadFromFile(fname));
+    ASSERT_EQ(d.aliveCount(), static_cast<std::size_t>(n + 1));
+    ASSERT_EQ(d.findNPC("npc_0")->type(), "Orc");
+    ASSERT_EQ(d.findNPC("npc_149000")->type(), "Orc");
+    ASSERT_NEAR(d.findNPC("npc_12345")->x(), 45.0, 0.001);
+    ASSERT_NE(d.findNPC("late"), nullptr);
+    ASSERT_EQ(d.findNPC("far"), nullptr);
+
+    std::remove(fname.c_str());
+}
+
+TEST(DungeonTests, EmptyTextFileLoadsEmptyWorld) {
+    // пустой файл не отображается в память, но читается как пустой мир
+    const std::string fname = "dungeon_empty_test.txt";
+    { std::ofstream f(fname); }
+
+    Dungeon d;
+    ASSERT_TRUE(d.addNPC(NPCFactory::create("Orc", "O1", 1.0, 1.0)));
+    ASSERT_TRUE(d.loadFromFile(fname));
+    ASSERT_EQ(d.aliveCount(), 0u);
+    ASSERT_FALSE(d.loadFromFile("dungeon_missing_test.txt"));
+
+    std::remove(fname.c_str());
+}
+
+TEST(DungeonTests, CompressedSnapshotRoundTrip) {
+    const std::string fname = "dungeon_compressed_test.cmp";
+    const std::string text = "dungeon_compressed_test.txt";
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> pos(0.0, 100.0);
+    Dungeon src;
+    const char* types[] = {"Orc", "Bear", "Squirrel", "Bandit", "Werewolf"};
+    for (int i = 0; i < 2000; ++i) {
+        src.addNPC(NPCFactory::create(types[i % 5], std::string(types[i % 5]) + "_" + std::to_string(i), pos(rng), pos(rng)));
+    }
+    // имена без числа, с ведущими нулями и с длинным числом; NPC на краю мира
+    src.addNPC(NPCFactory::create("Bear", "Bob", 100.0, 99.999));
+    src.addNPC(NPCFactory::create("Orc", "Orc_007", 0.0, 0.004));
+    src.addNPC(NPCFactory::create("Bandit", "x18446744073709551615", 1.0, 1.0));
+    auto dead = NPCFactory::create("Werewolf", "W_dead", 3.0, 4.0);
+    dead->markDead();
+    src.addNPC(std::move(dead));
+
+    ASSERT_FALSE(src.saveToFile(fname, WorldFormat::Compressed, 0.0));
+    ASSERT_TRUE(src.saveToFile(fname, WorldFormat::Compressed, 0.01));
+    ASSERT_TRUE(src.saveToFile(text));
+
+    Dungeon d;
+    ASSERT_TRUE(d.loadFromFile(fname));
+    ASSERT_EQ(d.aliveCount(), src.aliveCount());
+    for (const char* name : {"Orc_0", "Werewolf_1999", "Bob", "Orc_007", "x18446744073709551615", "W_dead", "Squirrel_1232"}) {
+        auto a = src.findNPC(name);
+        auto b = d.findNPC(name);
+        ASSERT_NE(b, nullptr) << name;
+        ASSERT_EQ(a->type(), b->type());
+        ASSERT_EQ(a->alive(), b->alive());
+        ASSERT_NEAR(a->x(), b->x(), 0.005 + 1e-9);
+        ASSERT_NEAR(a->y(), b->y(), 0.005 + 1e-9);
+    }
+
+    std::ifstream cf(fname, std::ios::binary | std::ios::ate), tf(text, std::ios::binary | std::ios::ate);
+    ASSERT_GE(static_cast<double>(tf.tellg()) / static_cast<double>(cf.tellg()), 5.0);
+
+    // обрезанный файл отвергается
+    {
+        std::ifstream in(fname, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(fname, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() / 2));
+    }
+    ASSERT_FALSE(d.loadFromFile(fname));
+
+    std::remove(fname.c_str());
+    std::remove(text.c_str());
+}
+
+TEST(DungeonTests, JournalReplaysSnapshotAndChanges) {
+    const std::string base = "dungeon_journal_test";
+    const std::string snap = base + ".snap", log = base + ".journal";
+    Dungeon d;
+    for (int i = 0; i < 100; ++i) {
+        d.addNPC(NPCFactory::create(i % 2 ? "Orc" : "Bear", "N" + std::to_string(i), i % 10 * 10.0, i / 10 * 10.0));
+    }
+    ASSERT_FALSE(d.checkpoint());
+    ASSERT_TRUE(d.startJournal(base));
+
+    // без изменений журнал не растёт
+    ASSERT_TRUE(d.checkpoint());
+    std::ifstream empty(log, std::ios::binary | std::ios::ate);
+    ASSERT_EQ(empty.tellg(), 0);
+
+    for (int i = 0; i < 5; ++i) {
+        d.runTicks(1);
+        ASSERT_TRUE(d.checkpoint());
+        if (i == 2) ASSERT_TRUE(d.addNPC(NPCFactory::create("Squirrel", "late", 50.0, 50.0)));
+    }
+    d.runTicks(1);
+    ASSERT_TRUE(d.checkpoint());
+
+    // оборванный последний кадр игнорируется
+    {
+        std::ofstream f(log, std::ios::binary | std::ios::app);
+        f.write("JRNL\xff\xff", 6);
+    }
+
+    Dungeon r;
+    ASSERT_TRUE(r.loadJournal(base));
+    ASSERT_EQ(r.aliveCount(), d.aliveCount());
+    ASSERT_LT(d.aliveCount(), 101u);
+    for (int i = 0; i <= 100; ++i) {
+        const std::string name = i < 100 ? "N" + std::to_string(i) : "late";
+        auto a = d.findNPC(name);
+        auto b = r.findNPC(name);
+        ASSERT_NE(b, nullptr);
+        ASSERT_EQ(a->alive(), b->alive());
+        ASSERT_NEAR(a->x(), b->x(), 1e-3);
+        ASSERT_NEAR(a->y(), b->y(), 1e-3);
+    }
+
+    d.stopJournal();
+    ASSERT_FALSE(d.checkpoint());
+    std::remove(snap.c_str());
+    std::remove(log.c_str());
+}
+
+TEST(DungeonTests, BinarySnapshotRoundTrip) {
+    const std::string fname = "dungeon_snapshot_test.bin";
+    Dungeon src;
+    src.setWorldSize(1000.0, 1000.0);
+    ASSERT_TRUE(src.addNPC(NPCFactory::create("Bear", "B1", 10.0, 20.0)));
+    ASSERT_TRUE(src.addNPC(NPCFactory::create("Squirrel", "S1", 0.1, 999.9)));
+    auto dead = NPCFactory::create("Orc", "O1", 500.0, 500.0);
+    dead->markDead();
+    ASSERT_TRUE(src.addNPC(std::move(dead)));
+    ASSERT_TRUE(src.saveToFile(fname, WorldFormat::Binary));
+
+    Dungeon d;
+    d.setWorldSize(1000.0, 1000.0);
+    ASSERT_TRUE(d.loadFromFile(fname));
+    ASSERT_EQ(d.aliveCount(), 2u);
+    auto s1 = d.findNPC("S1");
+    ASSERT_NE(s1, nullptr);
+    ASSERT_EQ(s1->type(), "Squirrel");
+    ASSERT_DOUBLE_EQ(s1->x(), 0.1);
+    ASSERT_DOUBLE_EQ(s1->y(), 999.9);
+    ASSERT_FALSE(d.findNPC("O1")->alive());
+
+    // границы мира проверяются так же, как для текстового формата
+    Dungeon small;
+    ASSERT_TRUE(small.loadFromFile(fname));
+    ASSERT_NE(small.findNPC("B1"), nullptr);
+    ASSERT_EQ(small.findNPC("S1"), nullptr);
+
+    // обрезанный файл отвергается, мир не меняется
+    {
+        std::ifstream in(fname, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(fname, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 1));
+    }
+    ASSERT_FALSE(d.loadFromFile(fname));
+    ASSERT_EQ(d.aliveCount(), 2u);
+
+    std::remove(fname.c_str());
+}
+
+namespace {
+    struct RecordingObserver : IObserver {
+        std::mutex m;
+        std::vector<DeathEvent> events;
+        void onDeath(const DeathEvent &ev) override {
+            std::lock_guard<std::mutex> lock(m);
+            events.push_back(ev);
+        }
+    };
+}
+
+TEST(DungeonTests, ParallelBattleKillsEachVictimOnce) {
+    Dungeon d;
+    ASSERT_TRUE(d.setWorkerCount(4));
+    auto rec = std::make_shared<RecordingObserver>();
+    d.events().subscribe(rec);
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> pos(0.0, 100.0);
+    for (int i = 0; i < 300; ++i) {
+        ASSERT_TRUE(d.addNPC(NPCFactory::create("Orc", "Orc_" + std::to_string(i), pos(rng), pos(rng))));
+    }
+
+    const TickStats stats = d.runTicks(5);
+    ASSERT_EQ(stats.ticks, 5u);
+    ASSERT_GT(stats.fights, 0u);
+
+    // 1. Каждый NPC умирает не больше одного раза, и счётчик живых совпадает с журналом
+    std::set<std::string> victims;
+    for (const auto &ev : rec->events) ASSERT_TRUE(victims.insert(ev.victim).second) << ev.victim;
+    ASSERT_FALSE(victims.empty());
+    ASSERT_EQ(stats.deaths, victims.size());
+    ASSERT_EQ(d.aliveCount(), 300u - victims.size());
+}
+
+namespace {
+    // журнал смертей прогона с заданным seed: ticks тиков через runTicks
+    // или потоковой симуляцией на ручных часах, которые двигает тест
+    std::vector<std::string> seededDeathLog(std::uint64_t seed, std::size_t workers, std::uint64_t ticks,
+                                            bool threaded = false) {
+        Dungeon d;
+        d.setWorkerCount(workers);
+        EXPECT_TRUE(d.setSeed(seed));
+        auto rec = std::make_shared<RecordingObserver>();
+        d.events().subscribe(rec);
+        std::mt19937 rng(2);
+        std::uniform_real_distribution<double> pos(0.0, 100.0);
+        const char* types[] = {"Orc", "Bear", "Squirrel", "Bandit", "Werewolf"};
+        for (int i = 0; i < 400; ++i) {
+            d.addNPC(NPCFactory::create(types[i % 5], "N" + std::to_string(i), pos(rng), pos(rng)));
+        }
+        if (!threaded) {
+            EXPECT_EQ(d.runTicks(ticks).ticks, ticks);
+        } else {
+            auto clock = std::make_shared<ManualTickClock>();
+            EXPECT_TRUE(d.setTickClock(clock));
+            EXPECT_TRUE(d.setTickRate(50.0));
+            d.startSimulation(0);
+            // следующий тик начинается, только когда тест сдвинет часы на период
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+            for (std::uint64_t k = 1; k <= ticks; ++k) {
+                while (d.tickStats().ticks < k && std::chrono::steady_clock::now() < deadline) std::this_thread::yield();
+                if (k < ticks) clock->advance(std::chrono::milliseconds(20));
+            }
+            d.stopSimulation();
+            d.joinSimulation();
+            EXPECT_GT(d.fightQueueStats().popped, 0u);
+            EXPECT_EQ(d.tickStats().ticks, ticks);
+        }
+
+        std::vector<std::string> log;
+        for (const auto &ev : rec->events) log.push_back(ev.killer + ">" + ev.victim);
+        return log;
+    }
+}
+
+TEST(DungeonTests, SeededRunsAreReproducible) {
+    auto a = seededDeathLog(42, 1, 6);
+    auto b = seededDeathLog(42, 4, 6);
+    ASSERT_FALSE(a.empty());
+    ASSERT_EQ(a, b);
+
+    auto c = seededDeathLog(43, 4, 6);
+    ASSERT_FALSE(c.empty());
+    ASSERT_NE(a, c);
+}
+
+TEST(DungeonTests, ThreadedSimulationMatchesRunTicks) {
+    auto threaded = seededDeathLog(42, 4, 12, true);
+    auto headless = seededDeathLog(42, 1, 12);
+    ASSERT_FALSE(threaded.empty());
+    ASSERT_EQ(threaded, headless);
+}
+
+namespace {
+    std::vector<std::string> crowdDeathLog(Dungeon &d, std::size_t minDead) {
+        EXPECT_TRUE(d.setSeed(8));
+        EXPECT_TRUE(d.setCompaction(minDead));
+        auto rec = std::make_shared<RecordingObserver>();
+        d.events().subscribe(rec);
+        std::mt19937 rng(6);
+        std::uniform_real_distribution<double> pos(0.0, 100.0);
+        const char* types[] = {"Orc", "Bear", "Squirrel", "Bandit", "Werewolf"};
+        for (int i = 0; i < 3000; ++i) {
+            d.addNPC(NPCFactory::create(types[i % 5], "Q" + std::to_string(i), pos(rng), pos(rng)));
+        }
+        d.runTicks(12);
+        std::vector<std::string> log;
+        for (const auto &ev : rec->events) log.push_back(ev.killer + ">" + ev.victim);
+        return log;
+    }
+}
+
+TEST(DungeonTests, CompactionKeepsSeededOutcome) {
+    Dungeon plain, compacted;
+    auto a = crowdDeathLog(plain, 0);
+    auto b = crowdDeathLog(compacted, 16);
+    ASSERT_FALSE(a.empty());
+    ASSERT_EQ(a, b);
+    ASSERT_EQ(plain.compactedCount(), 0u);
+    ASSERT_GT(compacted.compactedCount(), 0u);
+    ASSERT_EQ(plain.aliveCount(), compacted.aliveCount());
+    ASSERT_EQ(compacted.frame()->size(), 3000u - compacted.compactedCount());
+    ASSERT_EQ(plain.frame()->size(), 3000u);
+
+    // координаты выживших совпадают
+    auto f = compacted.frame();
+    for (NPCId id = 0; id < f->size(); ++id) {
+        auto p = plain.findNPC(f->name(id));
+        ASSERT_NE(p, nullptr);
+        ASSERT_DOUBLE_EQ(p->x(), f->x(id));
+    }
+}
+
+namespace {
+    // держит поток боя в первом же событии смерти, пока тест не отпустит
+    struct HoldingObserver : IObserver {
+        std::mutex m;
+        std::condition_variable cv;
+        std::vector<DeathEvent> events;
+        bool entered = false;
+        bool released = false;
+        void onDeath(const DeathEvent &ev) override {
+            std::unique_lock<std::mutex> lock(m);
+            events.push_back(ev);
+            entered = true;
+            cv.notify_all();
+            cv.wait(lock, [this]() { return released; });
+        }
+        void waitEntered() {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [this]() { return entered; });
+        }
+        void release() {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                released = true;
+            }
+            cv.notify_all();
+        }
+    };
+
+    template <class Pred>
+    bool waitFor(Pred pred) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (!pred()) {
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            std::this_thread::yield();
+        }
+        return true;
+    }
+}
+
+TEST(DungeonTests, CompactionWithFightsInFlight) {
+    // Мир 5 x 5 меньше дальности убийства орка: каждая пара дерётся каждый тик,
+    // 50 орков дают 1225 боёв — больше одной пачки. Поток боя стоит в первом
+    // событии, остаток тика 1 лежит в очереди, а тик 2 уплотняет мир под ним.
+    Dungeon d;
+    auto clock = std::make_shared<ManualTickClock>();
+    ASSERT_TRUE(d.setTickClock(clock));
+    ASSERT_TRUE(d.setTickRate(50.0));
+    ASSERT_TRUE(d.setCompaction(8));
+    ASSERT_TRUE(d.setWorldSize(5.0, 5.0));
+    auto rec = std::make_shared<HoldingObserver>();
+    d.events().subscribe(rec);
+    for (int i = 0; i < 50; ++i) {
+        ASSERT_TRUE(d.addNPC(NPCFactory::create("Orc", "W" + std::to_string(i), i % 5 * 1.0, i / 10 * 1.0)));
+    }
+
+    d.startSimulation(0);
+    rec->waitEntered();
+    ASSERT_TRUE(waitFor([&]() { return d.tickStats().ticks >= 1; }));
+    ASSERT_GT(d.fightQueueStats().depth, 0u);
+    ASSERT_EQ(d.compactedCount(), 0u);
+
+    clock->advance(std::chrono::milliseconds(20));
+    ASSERT_TRUE(waitFor([&]() { return d.tickStats().ticks >= 2; }));
+    ASSERT_GT(d.compactedCount(), 0u);
+    ASSERT_GT(d.fightQueueStats().depth, 0u);
+
+    // бои, записанные до уплотнения, разрешаются после него
+    rec->release();
+    ASSERT_TRUE(waitFor([&]() {
+        const QueueStats q = d.fightQueueStats();
+        return q.popped == q.pushed;
+    }));
+    d.stopSimulation();
+    d.joinSimulation();
+
+    std::set<std::string> victims;
+    for (const auto &ev : rec->events) ASSERT_TRUE(victims.insert(ev.victim).second) << ev.victim;
+    ASSERT_EQ(d.aliveCount(), 50u - victims.size());
+    for (const auto &v : victims) {
+        auto npc = d.findNPC(v);
+        if (npc) ASSERT_FALSE(npc->alive());
+    }
+}
+
+namespace {
+    struct CombatRun {
+        CombatSummary summary;
+        std::vector<std::string> log;
+        std::size_t aliveAfter;
+    };
+
+    CombatRun combatRound(std::size_t workers) {
+        Dungeon d;
+        d.setWorkerCount(workers);
+        EXPECT_TRUE(d.setSeed(11));
+        auto rec = std::make_shared<RecordingObserver>();
+        d.events().subscribe(rec);
+        std::mt19937 rng(4);
+        std::uniform_real_distribution<double> pos(0.0, 100.0);
+        const char* types[] = {"Orc", "Bear", "Squirrel", "Bandit", "Werewolf"};
+        for (int i = 0; i < 600; ++i) {
+            d.addNPC(NPCFactory::create(types[i % 5], "C" + std::to_string(i), pos(rng), pos(rng)));
+        }
+        CombatRun run{d.runCombat(5.0), {}, 0};
+        run.aliveAfter = d.aliveCount();
+        for (const auto &ev : rec->events) run.log.push_back(ev.killer + ">" + ev.victim);
+        return run;
+    }
+}
+
+TEST(DungeonTests, RunCombatIsDeterministic) {
+    CombatRun a = combatRound(1);
+    CombatRun b = combatRound(4);
+    ASSERT_GT(a.summary.pairs, 0u);
+    ASSERT_GT(a.summary.deaths, 0u);
+    ASSERT_EQ(a.log, b.log);
+    ASSERT_EQ(a.summary.pairs, b.summary.pairs);
+    ASSERT_EQ(a.summary.deaths, a.log.size());
+    ASSERT_EQ(a.summary.alive, a.aliveAfter);
+    ASSERT_EQ(a.aliveAfter, 600u - a.log.size());
+    ASSERT_EQ(b.aliveAfter, a.aliveAfter);
+
+    std::set<std::string> victims;
+    for (const auto &entry : a.log) ASSERT_TRUE(victims.insert(entry.substr(entry.find('>') + 1)).second);
+}
+
+TEST(DungeonTests, RunCombatUsesGivenRange) {
+    Dungeon d;
+    ASSERT_TRUE(d.addNPC(NPCFactory::create("Bear", "B1", 10.0, 10.0)));
+    ASSERT_TRUE(d.addNPC(NPCFactory::create("Squirrel", "S", 13.0, 10.0)));
+    ASSERT_TRUE(d.addNPC(NPCFactory::create("Bear", "B2", 11.0, 10.0)));
+    ASSERT_EQ(d.runCombat(0.0).pairs, 0u);
+    // медведи друг другу не враги
+    ASSERT_EQ(d.runCombat(1.5).pairs, 0u);
+
+    // B1-S на 3, B2-S на 2: общий S — две волны
+    CombatSummary s = d.runCombat(3.0);
+    ASSERT_EQ(s.pairs, 2u);
+    ASSERT_EQ(s.waves, 2u);
+    ASSERT_EQ(s.alive, d.aliveCount());
+}
+
+// --- V. Тестирование хранилища мира (WorldStore) ---
+
+TEST(WorldStoreTests, ColumnsAndFacade) {
+    WorldStore w;
+    auto orc = NPCFactory::create("Orc", "O1", 1.0, 2.0);
+    auto wolf = NPCFactory::create("Werewolf", "W1", 3.0, 4.0);
+    wolf->markDead();
+
+    NPCId a = w.add(*orc);
+    NPCId b = w.add(*wolf);
+    ASSERT_EQ(w.size(), 2u);
+
+    // 1. Колонки лежат подряд и совпадают со свойствами фасада
+    ASSERT_EQ(w.xs()[b], 3.0);
+    ASSERT_EQ(w.types()[a], NPCType::Orc);
+    ASSERT_EQ(w.moveDistance(a), orc->moveDistance());
+    ASSERT_EQ(w.killDistance(b), wolf->killDistance());
+    ASSERT_TRUE(w.alive(a));
+    ASSERT_FALSE(w.alive(b));
+
+    // 2. Обратное преобразование в NPCBase
+    w.setPosition(a, 7.0, 8.0);
+    auto back = w.materialize(a);
+    ASSERT_EQ(back->type(), "Orc");
+    ASSERT_EQ(back->name(), "O1");
+    ASSERT_NEAR(back->x(), 7.0, 0.001);
+    ASSERT_FALSE(w.materialize(b)->alive());
+}
+
+TEST(WorldStoreTests, NameIndex) {
+    WorldStore w;
+    for (int i = 0; i < 5000; ++i) w.add(NPCType::Orc, "Orc_" + std::to_string(i), 0.0, 0.0);
+    ASSERT_EQ(w.find("Orc_0"), 0u);
+    ASSERT_EQ(w.find("Orc_4999"), 4999u);
+    ASSERT_EQ(w.find("Orc_5000"), kNoNPC);
+
+    // первый NPC с таким именем остаётся в индексе
+    NPCId dup = w.add(NPCType::Bear, "Orc_7", 0.0, 0.0);
+    ASSERT_EQ(w.find("Orc_7"), 7u);
+    ASSERT_NE(dup, 7u);
+
+    w.clear();
+    ASSERT_EQ(w.find("Orc_0"), kNoNPC);
+}
+
+TEST(WorldStoreTests, CompactKeepsHandles) {
+    WorldStore w;
+    std::vector<NPCHandle> h;
+    for (int i = 0; i < 10; ++i) h.push_back(w.handle(w.add(NPCType::Orc, "N" + std::to_string(i), i, 0.0)));
+    for (int i = 0; i < 10; ++i) ASSERT_EQ(w.resolve(h[i]), static_cast<NPCId>(i));
+    for (NPCId id : {1u, 4u, 5u, 9u}) w.markDead(id);
+
+    ASSERT_EQ(w.compact(), 4u);
+    ASSERT_EQ(w.size(), 6u);
+    ASSERT_EQ(w.compact(), 0u);
+    // живые сохраняют порядок, описатели и имена
+    NPCId expected = 0;
+    for (int i = 0; i < 10; ++i) {
+        if (i == 1 || i == 4 || i == 5 || i == 9) {
+            ASSERT_EQ(w.resolve(h[i]), kNoNPC);
+            ASSERT_EQ(w.find("N" + std::to_string(i)), kNoNPC);
+            continue;
+        }
+        ASSERT_EQ(w.resolve(h[i]), expected);
+        ASSERT_EQ(w.name(expected), "N" + std::to_string(i));
+        ASSERT_DOUBLE_EQ(w.x(expected), i);
+        ASSERT_EQ(w.find("N" + std::to_string(i)), expected);
+        ++expected;
+    }
+
+    // освободившийся слот переиспользуется с новым поколением
+    NPCId fresh = w.add(NPCType::Bear, "fresh", 0.0, 0.0);
+    ASSERT_EQ(w.handle(fresh) & 0xFFFFFFFFu, h[1] & 0xFFFFFFFFu);
+    ASSERT_NE(w.handle(fresh), h[1]);
+    ASSERT_EQ(w.resolve(h[1]), kNoNPC);
+    ASSERT_EQ(w.resolve(w.handle(fresh)), fresh);
+}
+
+// --- VI. Тестирование пула потоков (WorkerPool) ---
+
+TEST(WorkerPoolTests, ParallelForCoversRangeOnce) {
+    WorkerPool pool(4);
+    ASSERT_EQ(pool.size(), 4u);
+
+    std::vector<std::atomic<int>> hits(10000);
+    std::atomic<std::size_t> maxWorker{0};
+    for (int round = 0; round < 3; ++round) {
+        pool.parallelFor(hits.size(), 100, [&](std::size_t begin, std::size_t end, std::size_t w) {
+            for (std::size_t i = begin; i < end; ++i) hits[i].fetch_add(1);
+            std::size_t cur = maxWorker.load();
+            while (w > cur && !maxWorker.compare_exchange_weak(cur, w)) {}
+        });
+    }
+    for (auto &h : hits) ASSERT_EQ(h.load(), 3);
+    ASSERT_LT(maxWorker.load(), pool.size());
+
+    // маленький диапазон выполняется целиком в вызывающем потоке
+    std::size_t calls = 0;
+    pool.parallelFor(50, 100, [&](std::size_t begin, std::size_t end, std::size_t w) {
+        ++calls;
+        ASSERT_EQ(begin, 0u);
+        ASSERT_EQ(end, 50u);
+        ASSERT_EQ(w, 0u);
+    });
+    ASSERT_EQ(calls, 1u);
+}
+
+// --- VII. Тестирование lock-free очереди (MpscRing) ---
+
+TEST(MpscRingTests, BatchPushPopAndStats) {
+    MpscRing<int> ring(8);
+    ASSERT_EQ(ring.capacity(), 8u);
+
+    int items[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    ASSERT_EQ(ring.tryPushBatch(items, 10), 8u);  // поместилось только 8
+    ASSERT_FALSE(ring.tryPush(42));
+    ASSERT_EQ(ring.depth(), 8u);
+
+    int out[16];
+    ASSERT_EQ(ring.tryPopBatch(out, 3), 3u);
+    ASSERT_EQ(out[0], 0);
+    ASSERT_EQ(out[2], 2);
+    ASSERT_TRUE(ring.tryPush(42));
+
+    QueueStats st = ring.stats();
+    ASSERT_EQ(st.depth, 6u);
+    ASSERT_EQ(st.highWater, 8u);
+    ASSERT_EQ(st.pushed, 9u);
+    ASSERT_EQ(st.popped, 3u);
+
+    ASSERT_EQ(ring.tryPopBatch(out, 16), 6u);
+    ASSERT_EQ(out[5], 42);
+}
+
+TEST(MpscRingTests, ManyProducersKeepPerProducerOrder) {
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 20000;
+    MpscRing<std::pair<int, int>> ring(256);
+    std::atomic<bool> stop{false};
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p]() {
+            std::pair<int, int> buf[16];
+            for (int i = 0; i < kPerProducer; i += 16) {
+                for (int k = 0; k < 16; ++k) buf[k] = {p, i + k};
+                ring.pushBatch(buf, 16, stop);
+            }
+        });
+    }
+
+    std::vector<int> next(kProducers, 0);
+    int received = 0;
+    std::pair<int, int> out[64];
+    while (received < kProducers * kPerProducer) {
+        std::size_t k = ring.popBatch(out, 64, stop);
+        for (std::size_t i = 0; i < k; ++i) {
+            ASSERT_EQ(out[i].second, next[out[i].first]);
+            ++next[out[i].first];
+        }
+        received += static_cast<int>(k);
+    }
+    for (auto &t : producers) t.join();
+    ASSERT_EQ(ring.depth(), 0u);
+    ASSERT_LE(ring.stats().highWater, ring.capacity());
+
+    // остановка будит спящего потребителя; ждём, пока он заснёт
+    const std::uint64_t parks = ring.stats().parks;
+    std::thread consumer([&]() { ASSERT_EQ(ring.popBatch(out, 64, stop), 0u); });
+    while (ring.stats().parks == parks) std::this_thread::yield();
+    stop.store(true);
+    ring.wakeConsumer();
+    consumer.join();
+}
+
+// --- VIII. Тестирование множества пар (PairSet) ---
+
+TEST(PairSetTests, DedupAcrossGenerations) {
+    PairSet set;
+    ASSERT_TRUE(set.insert(1, 2));
+    ASSERT_FALSE(set.insert(2, 1));  // пара неупорядоченная
+    ASSERT_TRUE(set.contains(1, 2));
+
+    // рост таблицы сохраняет содержимое
+    for (std::uint32_t i = 0; i < 1000; ++i) ASSERT_TRUE(set.insert(i, i + 5000));
+    ASSERT_EQ(set.size(), 1001u);
+    ASSERT_FALSE(set.insert(999, 5999));
+
+    // новый тик: таблица не чистится, но старые пары не видны
+    set.reset();
+    ASSERT_EQ(set.size(), 0u);
+    ASSERT_FALSE(set.contains(1, 2));
+    ASSERT_TRUE(set.insert(2, 1));
+}
+
+// --- IX. Асинхронный файловый логгер ---
+
+TEST(AsyncFileLoggerTests, WritesAllRecordsFromManyThreads) {
+    const std::string fname = "async_logger_test.txt";
+    std::remove(fname.c_str());
+    {
+        AsyncFileLogger log(fname, std::chrono::milliseconds(5));
+        ASSERT_TRUE(log.isOpen());
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&log, t]() {
+                for (int i = 0; i < 500; ++i) log.onDeath({"K" + std::to_string(t), "V" + std::to_string(i), 1.5, 2.0});
+            });
+        }
+        for (auto &th : threads) th.join();
+        log.flush();
+
+        LoggerStats st = log.stats();
+        ASSERT_EQ(st.written, 2000u);
+        ASSERT_EQ(st.dropped, 0u);
+        ASSERT_GE(st.queue.highWater, 1u);
+        ASSERT_LE(st.batches, st.written);
+    }
+
+    std::ifstream f(fname);
+    std::string line;
+    std::getline(f, line);
+    ASSERT_EQ(line.rfind(" в точке (1.5,2)"), line.size() - std::string(" в точке (1.5,2)").size());
+    int lines = 1;
+    while (std::getline(f, line)) ++lines;
+    ASSERT_EQ(lines, 2000);
+    std::remove(fname.c_str());
+}
+
+TEST(AsyncFileLoggerTests, TruncatesOnCharacterBoundary) {
+    const std::string fname = "async_logger_utf8_test.txt";
+    std::remove(fname.c_str());
+    // 2 + 23 * 2 байта: 48-й байт попадает внутрь буквы
+    std::string longName = "Xy";
+    for (int i = 0; i < 23; ++i) longName += "ы";
+    const std::string fitting = "Орк_1";
+    {
+        AsyncFileLogger log(fname, std::chrono::milliseconds(5));
+        log.onDeath({fitting, longName, 0, 0});
+        log.onDeath({fitting, fitting, 0, 0});
+        log.flush();
+        ASSERT_EQ(log.stats().truncated, 1u);
+        ASSERT_EQ(log.stats().written, 2u);
+    }
+
+    std::ifstream f(fname);
+    std::string line;
+    std::getline(f, line);
+    // из 48 байт места остаётся 47: целых букв помещается 22
+    const std::string kept = longName.substr(0, 2 + 22 * 2);
+    ASSERT_EQ(line, fitting + " убил " + kept + " в точке (0,0)");
+    std::getline(f, line);
+    ASSERT_EQ(line, fitting + " убил " + fitting + " в точке (0,0)");
+    std::remove(fname.c_str());
+}
+
+TEST(AsyncFileLoggerTests, DropsWhenQueueIsFull) {
+    const std::string fname = "async_logger_drop_test.txt";
+    std::remove(fname.c_str());
+    {
+        // поток записи не просыпается до деструктора
+        AsyncFileLogger log(fname, std::chrono::hours(1), 8);
+        for (int i = 0; i < 20; ++i) log.onDeath({"K", std::string(100, 'v'), 0.0, 0.0});
+        LoggerStats st = log.stats();
+        ASSERT_EQ(st.dropped, 12u);
+        ASSERT_EQ(st.queue.highWater, 8u);
+    }
+
+    // в деструкторе очередь дописана; длинное имя обрезано
+    std::ifstream f(fname);
+    std::string line;
+    int lines = 0;
+    while (std::getline(f, line)) {
+        ++lines;
+        ASSERT_EQ(line, "K убил " + std::string(kLogNameCap - 1, 'v') + " в точке (0,0)");
+    }
+    ASSERT_EQ(lines, 8);
+    std::remove(fname.c_str());
+}
+
+// --- X. Асинхронная рассылка событий (EventManager) ---
+
+namespace {
+
+struct SlowObserver : IObserver {
+    std::mutex m;
+    std::condition_variable cv;
+    std::vector<std::string> victims;
+    bool held = false;   // onDeath ждёт release()
+    void onDeath(const DeathEvent &ev) override {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [this]() { return !held; });
+        victims.push_back(ev.victim);
+    }
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            held = false;
+        }
+        cv.notify_all();
+    }
+};
+
+}
+
+TEST(EventManagerTests, AsyncBlockKeepsOrder) {
+    EventManager em;
+    auto obs = std::make_shared<SlowObserver>();
+    em.subscribe(obs);
+    ASSERT_TRUE(em.startAsync(4, OverflowPolicy::Block));
+    ASSERT_FALSE(em.startAsync(4));
+    for (int i = 0; i < 100; ++i) em.notify({"K", std::to_string(i), 0, 0});
+    em.waitIdle();
+
+    ASSERT_EQ(obs->victims.size(), 100u);
+    for (int i = 0; i < 100; ++i) ASSERT_EQ(obs->victims[i], std::to_string(i));
+    DispatchStats st = em.dispatchStats();
+    ASSERT_EQ(st.delivered, 100u);
+    ASSERT_EQ(st.dropped, 0u);
+    ASSERT_LE(st.highWater, 4u);
+    ASSERT_GE(st.maxLatencyUs, st.meanLatencyUs);
+    ASSERT_GT(st.p99LatencyUs, 0.0);
+
+    em.stopAsync();
+    ASSERT_FALSE(em.isAsync());
+    em.notify({"K", "sync", 0, 0});
+    ASSERT_EQ(obs->victims.back(), "sync");
+}
+
+TEST(EventManagerTests, DropPoliciesDoNotBlockProducer) {
+    for (OverflowPolicy policy : {OverflowPolicy::DropOldest, OverflowPolicy::DropNewest}) {
+        const char* name = policy == OverflowPolicy::DropOldest ? "DropOldest" : "DropNewest";
+        SCOPED_TRACE(name);
+        EventManager em;
+        auto obs = std::make_shared<SlowObserver>();
+        obs->held = true;
+        em.subscribe(obs);
+        ASSERT_TRUE(em.startAsync(2, policy));
+
+        // наблюдатель стоит, пока все события не отправлены: notify не может ждать его
+        for (int i = 0; i < 50; ++i) em.notify({"K", std::to_string(i), 0, 0});
+        obs->release();
+        em.stopAsync();
+
+        // при сбое печатается всё, что дошло до наблюдателя
+        DispatchStats st = em.dispatchStats();
+        std::string got;
+        for (const auto &v : obs->victims) got += v + " ";
+        ASSERT_EQ(st.delivered + st.dropped, 50u)
+            << "delivered=" << st.delivered << " dropped=" << st.dropped << " victims: " << got;
+        ASSERT_EQ(st.delivered, obs->victims.size()) << "victims: " << got;
+        ASSERT_GT(st.dropped, 0u) << "delivered=" << st.delivered << " victims: " << got;
+        ASSERT_FALSE(obs->victims.empty()) << "delivered=" << st.delivered << " dropped=" << st.dropped;
+        // доставленное идёт по возрастанию; последнее событие теряет только DropNewest
+        for (std::size_t i = 1; i < obs->victims.size(); ++i) {
+            ASSERT_LT(std::stoi(obs->victims[i - 1]), std::stoi(obs->victims[i])) << "at " << i << " victims: " << got;
+        }
+        if (policy == OverflowPolicy::DropOldest) ASSERT_EQ(obs->victims.back(), "49") << "victims: " << got;
+        else ASSERT_NE(obs->victims.back(), "49") << "victims: " << got;
+    }
+}
+
+// --- XI. Расписание тиков (TickScheduler) ---
+namespace {
+    // 8 тиков с периодом 5 мс на ручных часах; третий работает 17 мс, остальные — мгновенно
+    TickSchedulerStats runWithOverrun(OverrunPolicy policy) {
+        auto clock = std::make_shared<ManualTickClock>(true);
+        TickScheduler sched(std::chrono::milliseconds(5), policy, 8, clock);
+        sched.start();
+        for (int i = 0; i < 8 && sched.waitNext(); ++i) {
+            if (i == 2) clock->advance(std::chrono::milliseconds(17));
+            sched.endTick();
+        }
+        return sched.stats();
+    }
+}
+
+TEST(TickSchedulerTests, OverrunPolicies) {
+    TickSchedulerStats skip = runWithOverrun(OverrunPolicy::Skip);
+    // третий тик: начало 10 мс, конец 27 мс; слоты 15, 20, 25 прошли
+    ASSERT_EQ(skip.ticks, 8u);
+    ASSERT_EQ(skip.overruns, 1u);
+    ASSERT_EQ(skip.skipped, 3u);
+    ASSERT_EQ(skip.caughtUp, 0u);
+    ASSERT_DOUBLE_EQ(skip.maxWorkUs, 17000.0);
+    ASSERT_DOUBLE_EQ(skip.maxJitterUs, 0.0);
+    ASSERT_DOUBLE_EQ(skip.periodUs, 5000.0);
+
+    // пропущенные слоты отрабатываются подряд: тики 15, 20, 25 начинаются в 27
+    TickSchedulerStats catchUp = runWithOverrun(OverrunPolicy::CatchUp);
+    ASSERT_EQ(catchUp.overruns, 1u);
+    ASSERT_EQ(catchUp.skipped, 0u);
+    ASSERT_EQ(catchUp.caughtUp, 3u);
+    ASSERT_DOUBLE_EQ(catchUp.maxJitterUs, 12000.0);
+
+    TickSchedulerStats stretch = runWithOverrun(OverrunPolicy::Stretch);
+    ASSERT_EQ(stretch.overruns, 1u);
+    ASSERT_EQ(stretch.skipped, 0u);
+    ASSERT_EQ(stretch.caughtUp, 0u);
+}
+
+TEST(TickSchedulerTests, CancelWakesWaiter) {
+    // часы стоят: без отмены второй тик не начался бы никогда
+    auto clock = std::make_shared<ManualTickClock>();
+    TickScheduler sched(std::chrono::seconds(10), OverrunPolicy::Skip, 4, clock);
+    ASSERT_FALSE(sched.configure(std::chrono::seconds(0), OverrunPolicy::Skip));
+    sched.start();
+    ASSERT_TRUE(sched.waitNext());   // первый тик — сразу
+    sched.endTick();
+
+    std::thread canceller([&sched]() { sched.cancel(); });
+    ASSERT_FALSE(sched.waitNext());
+    canceller.join();
+
+    // сдвиг часов будит ожидающего
+    sched.start();
+    ASSERT_TRUE(sched.waitNext());
+    sched.endTick();
+    std::thread mover([&clock]() { clock->advance(std::chrono::seconds(10)); });
+    ASSERT_TRUE(sched.waitNext());
+    mover.join();
+
+    Dungeon d;
+    ASSERT_FALSE(d.setTickRate(0.0));
+    ASSERT_FALSE(d.setTickRate(std::nan("")));
+    ASSERT_TRUE(d.setTickRate(20.0, OverrunPolicy::CatchUp));
+}